@@ -0,0 +1,264 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ComponentStore.h"
+#include "Entity.h"
+
+// Stores entities that always carry the same set of components together, in fixed-size chunks.
+// Inside a chunk every component type gets its own packed column, so a query streams straight
+// through memory instead of hopping between managers.
+//
+// All chunks are full except the last: removal moves the very last row into the hole, so row order
+// is not stable and entities must not be added or removed while a Query is running.
+template <typename... Components> class Archetype final : public ComponentStore
+{
+	static_assert(sizeof...(Components) > 0, "An archetype needs at least one component.");
+	static_assert((std::is_trivially_copyable_v<Components> && ...),
+	              "Archetype moves rows with plain copies, so every component must be trivially copyable.");
+
+public:
+	static constexpr size_t CHUNK_BYTES      = 16 * 1024;
+	static constexpr size_t COLUMN_ALIGNMENT = 64;
+
+	// Column 0 is always the owning entity.
+	static constexpr size_t COLUMN_COUNT = sizeof...(Components) + 1;
+	static constexpr size_t ROW_BYTES    = sizeof(Entity) + (sizeof(Components) + ...);
+
+	// Leave room for padding every column out to COLUMN_ALIGNMENT.
+	static constexpr size_t ROWS_PER_CHUNK = (CHUNK_BYTES - COLUMN_ALIGNMENT * COLUMN_COUNT) / ROW_BYTES;
+
+	explicit Archetype(const size_t capacity = 0)
+	{
+		_Chunks.reserve((capacity + ROWS_PER_CHUNK - 1) / ROWS_PER_CHUNK);
+	}
+
+	// Adds the entity, or overwrites its components if it is already stored here.
+	void Add(const Entity entity, const Components&... components)
+	{
+		Reserve(_Size + 1);
+		WriteRow(std::index_sequence_for<Components...> {}, AcquireRow(entity), entity, components...);
+	}
+
+	// Adds `count` entities at once. Each argument points at `count` elements, so entities[i] gets
+	// components[i]. Chunks are allocated up front and the new rows are filled back to back.
+	void AddBatch(const size_t count, const Entity* entities, const Components*... components)
+	{
+		Reserve(_Size + count);
+		for(size_t i = 0; i < count; ++i)
+		{
+			WriteRow(std::index_sequence_for<Components...> {}, AcquireRow(entities[i]), entities[i], components[i]...);
+		}
+	}
+
+	// Makes sure there are chunks for at least `rows` rows.
+	void Reserve(const size_t rows)
+	{
+		while(_Chunks.size() * ROWS_PER_CHUNK < rows)
+		{
+			_Chunks.push_back(std::make_unique<Chunk>());
+		}
+	}
+
+	void Remove(const Entity entity)
+	{
+		size_t row;
+		if(!Lookup(entity, &row))
+			return;
+
+		const auto last = _Size - 1;
+		if(row != last)
+		{
+			CopyRow(std::make_index_sequence<COLUMN_COUNT> {}, last, row);
+			_Sparse[At<0>(row).Index()] = static_cast<uint32_t>(row);
+		}
+
+		_Sparse[entity.Index()] = INVALID_ROW;
+		--_Size;
+	}
+
+	bool Contains(const Entity entity) const
+	{
+		size_t row;
+		return Lookup(entity, &row);
+	}
+
+	// Returns nullptr if the entity isn't stored in this archetype.
+	template <typename T> T* Get(const Entity entity)
+	{
+		size_t row;
+		return Lookup(entity, &row) ? &At<IndexOf<T>()>(row) : nullptr;
+	}
+
+	template <typename T> const T* Get(const Entity entity) const
+	{
+		size_t row;
+		return Lookup(entity, &row) ? &At<IndexOf<T>()>(row) : nullptr;
+	}
+
+	void RemoveDestroyed(const DestroyedEntities& destroyed) override
+	{
+		for(const auto& entity : destroyed)
+		{
+			Remove(entity);
+		}
+	}
+
+	size_t Count() const
+	{
+		return _Size;
+	}
+
+	// Keeps the chunks around for reuse.
+	void Clear()
+	{
+		_Size = 0;
+		_Sparse.clear();
+	}
+
+	// Calls fn(count, entities, columns...) once per chunk. Each pointer is a packed array of `count`
+	// elements, one per requested component type, all sharing the same row order.
+	template <typename... Ts, typename Fn> void Query(Fn&& fn)
+	{
+		auto remaining = _Size;
+		for(size_t chunk = 0; remaining > 0; ++chunk)
+		{
+			const auto count = std::min(remaining, ROWS_PER_CHUNK);
+			fn(count,
+			   const_cast<const Entity*>(ColumnIn<0>(chunk)),
+			   ColumnIn<IndexOf<Ts>()>(chunk)...);
+			remaining -= count;
+		}
+	}
+
+	template <typename... Ts, typename Fn> void Query(Fn&& fn) const
+	{
+		auto remaining = _Size;
+		for(size_t chunk = 0; remaining > 0; ++chunk)
+		{
+			const auto count = std::min(remaining, ROWS_PER_CHUNK);
+			fn(count,
+			   const_cast<const Entity*>(ColumnIn<0>(chunk)),
+			   const_cast<const Ts*>(ColumnIn<IndexOf<Ts>()>(chunk))...);
+			remaining -= count;
+		}
+	}
+
+private:
+	template <size_t I> using ColumnType = std::tuple_element_t<I, std::tuple<Entity, Components...>>;
+
+	static constexpr uint32_t INVALID_ROW = UINT32_MAX;
+
+	struct Chunk
+	{
+		alignas(COLUMN_ALIGNMENT) uint8_t Data[CHUNK_BYTES];
+	};
+
+	template <typename T> static constexpr size_t IndexOf()
+	{
+		constexpr bool matches[] = { std::is_same_v<T, Entity>, std::is_same_v<T, Components>... };
+
+		for(size_t i = 0; i < COLUMN_COUNT; ++i)
+		{
+			if(matches[i])
+				return i;
+		}
+		return COLUMN_COUNT;
+	}
+
+	static constexpr size_t AlignUp(const size_t bytes)
+	{
+		return (bytes + COLUMN_ALIGNMENT - 1) & ~(COLUMN_ALIGNMENT - 1);
+	}
+
+	static constexpr std::array<size_t, COLUMN_COUNT + 1> ComputeOffsets()
+	{
+		constexpr size_t sizes[] = { sizeof(Entity), sizeof(Components)... };
+
+		std::array<size_t, COLUMN_COUNT + 1> offsets {};
+		size_t bytes = 0;
+		for(size_t i = 0; i < COLUMN_COUNT; ++i)
+		{
+			offsets[i] = bytes;
+			bytes      = AlignUp(bytes + sizes[i] * ROWS_PER_CHUNK);
+		}
+		offsets[COLUMN_COUNT] = bytes; // Total footprint, used to check we fit.
+		return offsets;
+	}
+
+	static constexpr std::array<size_t, COLUMN_COUNT + 1> OFFSETS = ComputeOffsets();
+	static_assert(OFFSETS[COLUMN_COUNT] <= CHUNK_BYTES, "Archetype columns overflow their chunk.");
+
+	template <size_t I> ColumnType<I>* ColumnIn(const size_t chunk) const
+	{
+		static_assert(I < COLUMN_COUNT, "Component type is not part of this archetype.");
+		return reinterpret_cast<ColumnType<I>*>(_Chunks[chunk]->Data + OFFSETS[I]);
+	}
+
+	template <size_t I> ColumnType<I>& At(const size_t row) const
+	{
+		return ColumnIn<I>(row / ROWS_PER_CHUNK)[row % ROWS_PER_CHUNK];
+	}
+
+	// Returns the entity's existing row, or claims the next free one. The caller must have reserved room.
+	size_t AcquireRow(const Entity entity)
+	{
+		size_t row;
+		if(Lookup(entity, &row))
+			return row;
+
+		row = _Size++;
+		assert(row < _Chunks.size() * ROWS_PER_CHUNK);
+
+		const auto slot = entity.Index();
+		if(slot >= _Sparse.size())
+		{
+			_Sparse.resize(static_cast<size_t>(slot) + 1, INVALID_ROW);
+		}
+		_Sparse[slot] = static_cast<uint32_t>(row);
+		return row;
+	}
+
+	bool Lookup(const Entity entity, size_t* row) const
+	{
+		const auto slot = entity.Index();
+		if(slot >= _Sparse.size())
+			return false;
+
+		const auto found = _Sparse[slot];
+
+		// The slot may belong to a stale entity from a previous generation, so confirm ownership.
+		if(found == INVALID_ROW || At<0>(found) != entity)
+			return false;
+
+		*row = found;
+		return true;
+	}
+
+	template <size_t... I>
+	void WriteRow(std::index_sequence<I...>, const size_t row, const Entity entity, const Components&... components)
+	{
+		At<0>(row) = entity;
+		((At<I + 1>(row) = components), ...);
+	}
+
+	template <size_t... I> void CopyRow(std::index_sequence<I...>, const size_t from, const size_t to)
+	{
+		((At<I>(to) = At<I>(from)), ...);
+	}
+
+	std::vector<std::unique_ptr<Chunk>> _Chunks;
+
+	// Indexed by Entity::Index(), holds the entity's global row. Row r lives in chunk r / ROWS_PER_CHUNK.
+	std::vector<uint32_t> _Sparse;
+
+	size_t _Size = 0;
+};
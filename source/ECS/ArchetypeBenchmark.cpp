@@ -0,0 +1,197 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "ArchetypeBenchmark.h"
+#include "BodyArchetype.h"
+#include "EntityManager.h"
+#include "RigidbodyManager.h"
+#include "TransformManager.h"
+
+#include "../Physics/Physics.h"
+#include "../State/Timer.h"
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t ASTEROIDS = 50000;
+
+constexpr int FRAMES = 60;
+
+constexpr float FIELD_SIZE = 2500.0f;
+constexpr float MAX_SPEED  = 200.0f;
+constexpr float DELTA_TIME = 1.0f / 60.0f;
+
+struct Asteroids
+{
+	std::vector<Entity> Entities;
+	std::vector<Transform> Transforms;
+	std::vector<Rigidbody> Rigidbodies;
+	std::vector<SpriteTransform> SpriteTransforms;
+	std::vector<SpriteFrameTimer> FrameTimers;
+};
+
+struct Result
+{
+	double EnqueueSeconds = 0.0;
+	double SyncSeconds    = 0.0;
+};
+
+double SecondsSince(const Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// The same as SpriteManager's, so both layouts do the same work.
+void SyncToTransform(SpriteTransform& spriteTrans, const Transform& transform)
+{
+	spriteTrans.Rotation   = transform.rot;
+	spriteTrans.Position.x = static_cast<int>(floor(transform.pos.x - static_cast<float>(spriteTrans.Position.w) / 2.0f));
+	spriteTrans.Position.y = static_cast<int>(floor(transform.pos.y - static_cast<float>(spriteTrans.Position.h) / 2.0f));
+}
+
+Asteroids MakeAsteroids(EntityManager& entities)
+{
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(0.0f, FIELD_SIZE);
+	std::uniform_real_distribution<float> velocity(-MAX_SPEED, MAX_SPEED);
+
+	Asteroids asteroids;
+	entities.CreateBatch(ASTEROIDS, asteroids.Entities);
+
+	const auto count = asteroids.Entities.size();
+	asteroids.Transforms.resize(count);
+	asteroids.Rigidbodies.resize(count);
+	asteroids.SpriteTransforms.resize(count);
+	asteroids.FrameTimers.resize(count);
+	for(size_t i = 0; i < count; ++i)
+	{
+		asteroids.Transforms[i].pos = Vector2(position(random), position(random));
+
+		auto& rb           = asteroids.Rigidbodies[i];
+		rb.entity          = asteroids.Entities[i];
+		rb.colliderType    = ColliderType::MEDIUM_ASTEROID;
+		rb.velocity        = Vector2(velocity(random), velocity(random));
+		rb.angularVelocity = 0.0f;
+
+		asteroids.SpriteTransforms[i].Position.w = 28;
+		asteroids.SpriteTransforms[i].Position.h = 28;
+	}
+	return asteroids;
+}
+
+// Each store in its own order, as they end up once a game has been creating and destroying for a while, so every
+// rigidbody and sprite looks up its transform somewhere else.
+Result MeasureSeparate(ThreadPool& workers, const Asteroids& asteroids)
+{
+	const auto fieldDim = Vector2::One() * FIELD_SIZE;
+	const auto count    = asteroids.Entities.size();
+
+	BodyArchetype bodies;
+	TransformManager transforms(bodies, static_cast<int>(count));
+	RigidbodyManager rigidbodies(bodies, static_cast<int>(count));
+	Physics physics(transforms, rigidbodies, workers, fieldDim);
+
+	std::mt19937 random(5678);
+	std::vector<size_t> order(count);
+	for(size_t i = 0; i < count; ++i)
+		order[i] = i;
+
+	transforms.AddBatch(asteroids.Entities.data(), asteroids.Transforms.data(), count);
+
+	std::shuffle(order.begin(), order.end(), random);
+	for(const auto i : order)
+		rigidbodies.AddBatch(&asteroids.Rigidbodies[i], 1);
+
+	std::shuffle(order.begin(), order.end(), random);
+	std::vector<Entity> spriteEntities;
+	std::vector<SpriteTransform> spriteTransforms;
+	for(const auto i : order)
+	{
+		spriteEntities.push_back(asteroids.Entities[i]);
+		spriteTransforms.push_back(asteroids.SpriteTransforms[i]);
+	}
+
+	Result result;
+	for(auto frame = 0; frame < FRAMES; ++frame)
+	{
+		const auto enqueueStart = Clock::now();
+		rigidbodies.EnqueueAll(physics, DELTA_TIME);
+		result.EnqueueSeconds += SecondsSince(enqueueStart);
+		physics.EndFrame();
+
+		const auto syncStart = Clock::now();
+		for(size_t i = 0; i < spriteEntities.size(); ++i)
+		{
+			if(const auto transform = transforms.Get(spriteEntities[i]))
+				SyncToTransform(spriteTransforms[i], transform.value());
+		}
+		result.SyncSeconds += SecondsSince(syncStart);
+	}
+	return result;
+}
+
+Result MeasureArchetype(ThreadPool& workers, const Asteroids& asteroids)
+{
+	const auto fieldDim = Vector2::One() * FIELD_SIZE;
+	const auto count    = asteroids.Entities.size();
+
+	BodyArchetype bodies(count);
+	TransformManager transforms(bodies, 0);
+	RigidbodyManager rigidbodies(bodies, 0);
+	Physics physics(transforms, rigidbodies, workers, fieldDim);
+
+	bodies.AddBatch(count,
+	                asteroids.Entities.data(),
+	                asteroids.Transforms.data(),
+	                asteroids.Rigidbodies.data(),
+	                asteroids.SpriteTransforms.data(),
+	                asteroids.FrameTimers.data());
+
+	Result result;
+	for(auto frame = 0; frame < FRAMES; ++frame)
+	{
+		const auto enqueueStart = Clock::now();
+		rigidbodies.EnqueueAll(physics, DELTA_TIME);
+		result.EnqueueSeconds += SecondsSince(enqueueStart);
+		physics.EndFrame();
+
+		const auto syncStart = Clock::now();
+		bodies.Query<Transform, SpriteTransform>(
+			[](const size_t rows, const Entity*, const Transform* bodyTransforms, SpriteTransform* spriteTransforms)
+			{
+				for(size_t i = 0; i < rows; ++i)
+					SyncToTransform(spriteTransforms[i], bodyTransforms[i]);
+			});
+		result.SyncSeconds += SecondsSince(syncStart);
+	}
+	return result;
+}
+}
+
+void
+ArchetypeBenchmark::Run(ThreadPool& workers)
+{
+	Timer time;
+	EntityManager entities(time);
+	const auto asteroids = MakeAsteroids(entities);
+
+	const auto separate  = MeasureSeparate(workers, asteroids);
+	const auto archetype = MeasureArchetype(workers, asteroids);
+
+	const auto perAsteroid = static_cast<double>(asteroids.Entities.size()) * FRAMES;
+	const auto nsPer       = [&](const double seconds)
+	{
+		return seconds * 1e9 / perAsteroid;
+	};
+
+	std::cout << "Archetype benchmark, " << asteroids.Entities.size() << " asteroids over " << FRAMES << " frames:\n"
+		<< "  Separate stores:   Enqueue " << nsPer(separate.EnqueueSeconds) << " ns."
+		<< "   Sprite sync " << nsPer(separate.SyncSeconds) << " ns per asteroid.\n"
+		<< "  Archetype chunks:  Enqueue " << nsPer(archetype.EnqueueSeconds) << " ns."
+		<< "   Sprite sync " << nsPer(archetype.SyncSeconds) << " ns per asteroid.\n";
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+class ThreadPool;
+
+// Debug benchmark for the body archetype, toggled from the debug keys. Puts the same 50k asteroids first in the
+// separate transform, rigidbody and sprite stores, then in a BodyArchetype. It times the physics enqueue and the
+// sprite sync over each and prints the cost per asteroid. Blocks until it's done.
+namespace ArchetypeBenchmark
+{
+void Run(ThreadPool& workers);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Archetype.h"
+#include "Rigidbody.h"
+#include "Transform.h"
+
+#include "../Renderer/SpriteTransform.h"
+
+// Time left on the current frame of a body's sprite animation.
+struct SpriteFrameTimer
+{
+	float Remaining = 0.0f;
+};
+
+// Asteroids and bullets always carry a transform, a rigidbody and a repeating sprite, so they live
+// together here instead of being spread over TransformManager, RigidbodyManager and SpriteManager.
+// Those managers still answer lookups for bodies by forwarding to this store.
+using BodyArchetype = Archetype<Transform, Rigidbody, SpriteTransform, SpriteFrameTimer>;
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// A non-owning view over one column of a ComponentColumns store.
+template <typename T> struct ColumnSpan
+{
+	T* Data;
+	size_t Size;
+
+	T& operator[](const size_t index) const
+	{
+		assert(index < Size);
+		return Data[index];
+	}
+
+	// ReSharper disable once CppInconsistentNaming
+	T* begin() const { return Data; }
+	// ReSharper disable once CppInconsistentNaming
+	T* end() const { return Data + Size; }
+};
+
+// Structure-of-arrays storage for plain component data. Every column lives in the same allocation, each one
+// starting on a COLUMN_ALIGNMENT boundary so that a column can be streamed with wide loads. Rows are kept
+// packed: removal swaps the last row into the hole, so row order is not stable.
+template <typename... Columns> class ComponentColumns
+{
+	static_assert(sizeof...(Columns) > 0, "ComponentColumns needs at least one column.");
+	static_assert((std::is_trivially_copyable_v<Columns> && ...),
+	              "ComponentColumns moves rows with memcpy, so every column type must be trivially copyable.");
+
+public:
+	static constexpr size_t COLUMN_ALIGNMENT = 64;
+	static constexpr size_t COLUMN_COUNT     = sizeof...(Columns);
+
+	template <size_t I> using ColumnType = std::tuple_element_t<I, std::tuple<Columns...>>;
+
+	explicit ComponentColumns(const size_t capacity = 0)
+	{
+		if(capacity > 0)
+			Reallocate(capacity);
+	}
+
+	~ComponentColumns()
+	{
+		if(_Buffer)
+			::operator delete(_Buffer, std::align_val_t(COLUMN_ALIGNMENT));
+	}
+
+	ComponentColumns(const ComponentColumns&) = delete;
+	ComponentColumns& operator=(const ComponentColumns&) = delete;
+
+	// Moving hands the buffer over, so stores can live in growable containers.
+	ComponentColumns(ComponentColumns&& other) noexcept
+		: _Buffer(other._Buffer),
+		  _Columns(other._Columns),
+		  _Size(other._Size),
+		  _Capacity(other._Capacity)
+	{
+		other._Buffer   = nullptr;
+		other._Columns  = {};
+		other._Size     = 0;
+		other._Capacity = 0;
+	}
+
+	ComponentColumns& operator=(ComponentColumns&& other) noexcept
+	{
+		std::swap(_Buffer, other._Buffer);
+		std::swap(_Columns, other._Columns);
+		std::swap(_Size, other._Size);
+		std::swap(_Capacity, other._Capacity);
+		return *this;
+	}
+
+	size_t Size() const { return _Size; }
+	size_t Capacity() const { return _Capacity; }
+
+	// Makes room for at least `capacity` rows. Grows by at least double, so reserving ahead of every
+	// small batch stays amortised O(1).
+	void Reserve(const size_t capacity)
+	{
+		if(capacity > _Capacity)
+			Reallocate(capacity > _Capacity * 2 ? capacity : _Capacity * 2);
+	}
+
+	// Appends a row and returns its index. Grows geometrically, so a run of pushes is amortised O(1).
+	size_t PushBack(const Columns&... values)
+	{
+		if(_Size == _Capacity)
+			Reallocate(_Capacity < 8 ? 8 : _Capacity * 2);
+
+		PushBackImpl(std::index_sequence_for<Columns...> {}, values...);
+		return _Size++;
+	}
+
+	// Moves the last row into `index` and shrinks by one.
+	void SwapRemove(const size_t index)
+	{
+		assert(index < _Size);
+		const auto last = _Size - 1;
+		if(index != last)
+			CopyRowImpl(std::index_sequence_for<Columns...> {}, last, index);
+		--_Size;
+	}
+
+	void Swap(const size_t a, const size_t b)
+	{
+		if(a != b)
+			SwapImpl(std::index_sequence_for<Columns...> {}, a, b);
+	}
+
+	void Clear()
+	{
+		_Size = 0;
+	}
+
+	template <size_t I> ColumnSpan<ColumnType<I>> Column()
+	{
+		return { std::get<I>(_Columns), _Size };
+	}
+
+	template <size_t I> ColumnSpan<const ColumnType<I>> Column() const
+	{
+		return { std::get<I>(_Columns), _Size };
+	}
+
+private:
+	static constexpr size_t AlignUp(const size_t bytes)
+	{
+		return (bytes + COLUMN_ALIGNMENT - 1) & ~(COLUMN_ALIGNMENT - 1);
+	}
+
+	void Reallocate(const size_t newCapacity)
+	{
+		ReallocateImpl(std::index_sequence_for<Columns...> {}, newCapacity);
+	}
+
+	template <size_t... I> void ReallocateImpl(std::index_sequence<I...>, const size_t newCapacity)
+	{
+		assert(newCapacity >= _Size);
+
+		// Lay the columns out back to back, each starting on an aligned boundary.
+		size_t offsets[COLUMN_COUNT];
+		size_t bytes = 0;
+		((offsets[I] = bytes, bytes = AlignUp(bytes + sizeof(Columns) * newCapacity)), ...);
+
+		auto* newBuffer = static_cast<uint8_t*>(::operator new(bytes, std::align_val_t(COLUMN_ALIGNMENT)));
+		std::tuple<Columns*...> newColumns { reinterpret_cast<Columns*>(newBuffer + offsets[I])... };
+
+		if(_Size > 0)
+			(memcpy(std::get<I>(newColumns), std::get<I>(_Columns), sizeof(Columns) * _Size), ...);
+
+		if(_Buffer)
+			::operator delete(_Buffer, std::align_val_t(COLUMN_ALIGNMENT));
+
+		_Buffer   = newBuffer;
+		_Columns  = newColumns;
+		_Capacity = newCapacity;
+	}
+
+	template <size_t... I> void PushBackImpl(std::index_sequence<I...>, const Columns&... values)
+	{
+		((std::get<I>(_Columns)[_Size] = values), ...);
+	}
+
+	template <size_t... I> void CopyRowImpl(std::index_sequence<I...>, const size_t from, const size_t to)
+	{
+		((std::get<I>(_Columns)[to] = std::get<I>(_Columns)[from]), ...);
+	}
+
+	template <size_t... I> void SwapImpl(std::index_sequence<I...>, const size_t a, const size_t b)
+	{
+		(std::swap(std::get<I>(_Columns)[a], std::get<I>(_Columns)[b]), ...);
+	}
+
+	void* _Buffer = nullptr;
+	std::tuple<Columns*...> _Columns {};
+
+	size_t _Size     = 0;
+	size_t _Capacity = 0;
+};
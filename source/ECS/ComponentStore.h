@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Entity.h"
+
+// The entities destroyed since the last garbage collection. EntityManager builds this once per frame and hands
+// the same view to every registered store, so each store evicts its dead rows in one pass and nobody else ever
+// has to ask whether an entity is still alive.
+class DestroyedEntities
+{
+public:
+	DestroyedEntities(const std::vector<Entity>& entities, const std::vector<uint64_t>& bits)
+		: _Entities(entities),
+		  _Bits(bits)
+	{
+	}
+
+	size_t Count() const { return _Entities.size(); }
+	bool IsEmpty() const { return _Entities.empty(); }
+
+	// O(1). Stores that can't look entities up by index can sweep their rows once and test each one.
+	//@NOTE: Only the slot is checked. A store can't hold an older generation of a destroyed slot (that one was
+	// evicted when it died), and the slot isn't reissued until the broadcast is over.
+	bool Contains(const Entity entity) const
+	{
+		const auto index = entity.Index();
+		return (index >> 6) < _Bits.size() && (_Bits[index >> 6] >> (index & 63) & 1) != 0;
+	}
+
+	// ReSharper disable once CppInconsistentNaming
+	std::vector<Entity>::const_iterator begin() const { return _Entities.begin(); }
+	// ReSharper disable once CppInconsistentNaming
+	std::vector<Entity>::const_iterator end() const { return _Entities.end(); }
+
+private:
+	const std::vector<Entity>& _Entities;
+	const std::vector<uint64_t>& _Bits;
+};
+
+// Anything that keeps per-entity data. Register with EntityManager::RegisterStore to be told when entities die.
+class ComponentStore
+{
+public:
+	virtual ~ComponentStore() = default;
+
+	virtual void RemoveDestroyed(const DestroyedEntities& destroyed) = 0;
+};
@@ -1,68 +1,82 @@
 #pragma once
 
 #include <stdint.h>
+#include <limits>
 #include <string>
+#include <type_traits>
 
-class Entity
+template <typename IndexType, typename GenerationType> class BasicEntity
 {
+	static_assert(std::is_unsigned_v<IndexType> && std::is_unsigned_v<GenerationType>,
+	              "Entity indices and generations must be unsigned integers.");
+
 public:
-	//@NOTE: Change these to 32/64 if necessary
-	typedef uint16_t EID;
-	static const EID EID_MAX = UINT16_MAX;
+	typedef IndexType EID;
+	typedef GenerationType Generation;
+	static constexpr EID EID_MAX = std::numeric_limits<EID>::max();
 
-	bool operator==(const Entity& other) const
+	bool operator==(const BasicEntity& other) const
 	{
-		return _ID == other._ID;
+		return _ID == other._ID && _Generation == other._Generation;
 	}
 
-	bool operator!=(const Entity& other) const
+	bool operator!=(const BasicEntity& other) const
 	{
-		return _ID != other._ID;
+		return !(*this == other);
 	}
 
 	size_t Hash() const {
-		return std::hash<uint32_t>{}(_ID);
+		return std::hash<uint64_t>{}((static_cast<uint64_t>(_Generation) << 32) | _ID);
 	}
 
-	static Entity Null()
+	static BasicEntity Null()
 	{
-		Entity retVal;
-		retVal._ID = 0;
+		BasicEntity retVal;
+		retVal._ID         = 0;
+		retVal._Generation = 0;
 		return retVal;
 	}
 
+	// The slot this entity occupies. Slots are recycled, so two different entities can share an index,
+	// but never at the same time. Safe to use as a direct array index in component stores.
+	EID Index() const
+	{
+		return _ID;
+	}
+
 	std::string ToString() const
 	{
-		return std::to_string(_ID);
+		return std::to_string(_ID) + ":" + std::to_string(_Generation);
 	}
 
-	bool operator<(const Entity& Other) const
+	bool operator<(const BasicEntity& Other) const
 	{
-		return this->_ID < Other._ID;
+		if(this->_ID != Other._ID)
+			return this->_ID < Other._ID;
+		return this->_Generation < Other._Generation;
 	}
 
 private:
 
 	EID _ID;
-	Entity& operator++()
-	{
-		++_ID;
-		return *this;
-	}
+	Generation _Generation;
 
-	Entity operator++(int)
-	{
-		const auto copy = *this;
-		++_ID;
-		return copy;
-	}
 	friend class EntityManager;
 };
 
+//@NOTE: The handle width is picked at compile time. 16-bit handles cap us at 65535 live entities, which is plenty
+// for the game itself and keeps every handle at 4 bytes. Define EUANITY_WIDE_ENTITIES for 32-bit handles, which
+// the entity stress test needs to get past 64k.
+#ifdef EUANITY_WIDE_ENTITIES
+using Entity = BasicEntity<uint32_t, uint32_t>;
+#else
+using Entity = BasicEntity<uint16_t, uint16_t>;
+#endif
+
 namespace std {
-	template<>
-	struct hash<Entity> {
-		size_t operator()(const Entity& Entity) const noexcept
+	template<typename IndexType, typename GenerationType>
+	struct hash<BasicEntity<IndexType, GenerationType>> {
+		size_t operator()(const BasicEntity<IndexType, GenerationType>& Entity) const noexcept
 		{
 			return Entity.Hash();
 		}
@@ -1,5 +1,6 @@
 #include "EntityManager.h"
 
+#include <algorithm>
 #include <assert.h>
 
 #include "../State/Timer.h"
@@ -8,201 +9,248 @@
 //@TODO: Does this class GUARANTEE that it will never return or create a null entity implicitly?
 
 EntityManager::EntityManager(const Timer& time)
-	//@NOTE @IMPORTANT: It is unlikely that we'll destroy more than 1024 entities in two frames, but if we do, bump this number!
-	: ZombieList(1024),
-	  _Time(time)
+	: _Time(time),
+	  _DeathRow(DEATH_ROW_TICK, 1024)
 {
 	// @NOTE: Entity.id == 0 is considered to be the null entity and is never available.
+	_Slots.reserve(1024);
+	_Slots.emplace_back();
 
-	_OpenRanges.push_back({ 1, Entity::EID_MAX });
+	_Zombies.reserve(1024);
 }
 
 Entity
 EntityManager::Create()
 {
-	if(_OpenRanges[0].Begin <= _OpenRanges[0].End)
+	Entity::EID index;
+	if(_FreeHead != 0)
 	{
-		Entity RetVal;
-		RetVal._ID = _OpenRanges[0].Begin++;
-		if(_OpenRanges[0].Begin > _OpenRanges[0].End && _OpenRanges.size() > 1)
-		{
-			// We've outrun this range, progress to the next.
-			_OpenRanges.erase(_OpenRanges.begin());
-		}
-
-		return RetVal;
+		// Recycle the slot that has been sitting in the pool the longest.
+		index     = _FreeHead;
+		_FreeHead = _Slots[index].NextFree;
+		if(_FreeHead == 0)
+			_FreeTail = 0;
+	}
+	else if(_Slots.size() <= Entity::EID_MAX)
+	{
+		index = static_cast<Entity::EID>(_Slots.size());
+		_Slots.emplace_back();
+	}
+	else
+	{
+		assert(!"We have overrun our entity limit!");
+		return Entity::Null();
 	}
 
-	static_assert("We have overrun our entity limit!");
-	return Entity::Null();
+	++_Count;
+
+	Entity RetVal;
+	RetVal._ID         = index;
+	RetVal._Generation = _Slots[index].Generation;
+	return RetVal;
 }
 
 bool
 EntityManager::Exists(const Entity entity) const
 {
-	if(entity._ID == 0)
-		return false; // Hard-coded zero entity
+	if(entity._ID == 0 || entity._ID >= _Slots.size())
+		return false; // Hard-coded zero entity, or an ID we never handed out.
+
+	const auto& slot = _Slots[entity._ID];
+	return slot.Generation == entity._Generation && !slot.IsZombie;
+}
+
+void
+EntityManager::Destroy(const Entity entity)
+{
+	// Rejects the null entity (it is too POWERFULLLL!!!), stale handles whose slot has since been
+	// recycled, and entities that are already zombies.
+	if(!Exists(entity))
+		return;
+
+	CancelDeathTimer(entity._ID);
+
+	_Slots[entity._ID].IsZombie = true;
+
+	const auto word = static_cast<size_t>(entity._ID >> 6);
+	if(word >= _ZombieBits.size())
+		_ZombieBits.resize(word + 1, 0);
+	_ZombieBits[word] |= uint64_t(1) << (entity._ID & 63);
+
+	_Zombies.push_back(entity);
+}
+
+void
+EntityManager::CreateBatch(const size_t count, std::vector<Entity>& out)
+{
+	out.reserve(out.size() + count);
 
-	// Binary search ranges
-	size_t min = 0;
-	auto max   = _OpenRanges.size() - 1;
+	size_t created = 0;
 
-	while(true)
+	// Drain the free list first, oldest slot first, same as Create().
+	while(created < count && _FreeHead != 0)
 	{
-		const auto i = (min + max) / 2;
+		const auto index = _FreeHead;
+		_FreeHead        = _Slots[index].NextFree;
+
+		Entity entity;
+		entity._ID         = index;
+		entity._Generation = _Slots[index].Generation;
+		out.push_back(entity);
+		++created;
+	}
+	if(_FreeHead == 0)
+		_FreeTail = 0;
 
-		if(entity._ID < _OpenRanges[i].Begin)
-		{
-			if(i == min)
-				return !ZombieList.Contains(entity);
-			max = i - 1;
-		}
-		else if(entity._ID > _OpenRanges[i].End)
+	// Then grow the slot table in one go for whatever is left.
+	if(created < count)
+	{
+		const auto available = static_cast<size_t>(Entity::EID_MAX) + 1 - _Slots.size();
+		const auto fresh     = std::min(count - created, available);
+		if(fresh < count - created)
 		{
-			if(i == max)
-				return !ZombieList.Contains(entity);
-			min = i + 1;
+			assert(!"We have overrun our entity limit!");
 		}
-		else
+
+		const auto first = _Slots.size();
+		_Slots.resize(first + fresh);
+		for(size_t i = 0; i < fresh; ++i)
 		{
-			return false;
+			Entity entity;
+			entity._ID         = static_cast<Entity::EID>(first + i);
+			entity._Generation = 0;
+			out.push_back(entity);
 		}
+		created += fresh;
 	}
+
+	_Count += static_cast<uint32_t>(created);
 }
 
 void
-EntityManager::Destroy(const Entity entity)
+EntityManager::DestroyBatch(const Entity* entities, const size_t count)
 {
-	if(entity == Entity::Null())
-		return; // The null entity cannot be destroyed! It is too POWERFULLLL!!!
-
-	if(!ZombieList.Contains(entity))
+	for(size_t i = 0; i < count; ++i)
 	{
-		++_ZombieCount;
-		ZombieList.Enqueue(entity);
-		assert(!ZombieList.IsFull());
-	}
-	else
-	{
-		//std::cout << "Attempting to destroy zombie entity " << entity.ToString() << "!\n";
+		Destroy(entities[i]);
 	}
 }
 
-
 void
-EntityManager::DestroyZombies(const Entity entity)
+EntityManager::ReleaseZombie(const Entity entity)
 {
-	_DeathRow.remove(entity);
+	_ZombieBits[entity._ID >> 6] &= ~(uint64_t(1) << (entity._ID & 63));
 
-	const Entity::EID entityEID      = entity._ID;
-	const Entity::EID entityPlusOne  = entityEID + 1;
-	const Entity::EID entityMinusOne = entityEID - 1;
+	auto& slot = _Slots[entity._ID];
 
-	for(auto Range = _OpenRanges.begin();
-	    Range != _OpenRanges.end(); ++Range)
-	{
-		if(entityEID < Range->Begin)
-		{
-			if(entityPlusOne == Range->Begin)
-			{
-				--Range->Begin;
-				return;
-			}
-			else
-			{
-				// We need to add a new range.
-				_OpenRanges.insert(Range, { entityEID, entityEID });
-				return;
-			}
-		}
+	// Bumping the generation invalidates every outstanding handle to this slot.
+	slot.IsZombie = false;
+	++slot.Generation;
+	slot.NextFree = 0;
 
-		if(entityMinusOne == Range->End)
-		{
-			// Extend the open range to include the destroyed entity
-			++Range->End;
-			const auto nextRange = Range + 1;
-			if(Range->End + 1 == nextRange->Begin)
-			{
-				// Combine this range with the one above it
-				Range->End = nextRange->End;
-				_OpenRanges.erase(nextRange);
-			}
-			return;
-		}
+	if(_FreeTail != 0)
+		_Slots[_FreeTail].NextFree = entity._ID;
+	else
+		_FreeHead = entity._ID;
+	_FreeTail = entity._ID;
 
-		if(entityPlusOne == Range->Begin)
-		{
-			// Extend the open range to include the destroyed entity
-			--Range->Begin;
-			return;
-		}
-	}
+	--_Count;
 }
 
 void
-EntityManager::DestroyDelayed(Entity entity, const float& seconds)
+EntityManager::DestroyDelayed(const Entity entity, const float& seconds)
 {
-	_DeathRow.push({ _Time.Now() + seconds, entity });
+	if(!Exists(entity))
+		return;
+
+	CancelDeathTimer(entity._ID);
+	_Slots[entity._ID].DeathTimer = _DeathRow.Schedule(_Time.Now() + seconds, entity);
+}
+
+void
+EntityManager::CancelDeathTimer(const Entity::EID index)
+{
+	auto& timer = _Slots[index].DeathTimer;
+	if(timer.IsValid())
+	{
+		_DeathRow.Cancel(timer);
+		timer = DeathRow::Handle();
+	}
 }
 
 void
 EntityManager::GarbageCollect()
 {
 	// There are two concepts at play for entity deletion.
-	// DeathRow is a list of entities and timers. When the timers expire, the entities will be Destroy()ed.
+	// DeathRow is a timing wheel of entities. When their timers expire, the entities will be Destroy()ed.
+	// Only the buckets that come due are touched, so this costs nothing when nobody is dying.
 
-	while(_DeathRow.size() > 0)
+	_DeathRow.Advance(_Time.Now(), [this](const Entity entity)
 	{
-		const auto& [deathTime, entity] = _DeathRow.top();
-		if(deathTime < _Time.Now())
-		{
-			// std::cout << "Killing Entity " << entity.ToString() << " on Death Row.\n";
+		// std::cout << "Killing Entity " << entity.ToString() << " on Death Row.\n";
 
-			Destroy(entity);
-			_DeathRow.pop();
-		}
-		else
-		{
-			break;
-		}
-	}
+		_Slots[entity._ID].DeathTimer = DeathRow::Handle();
+		Destroy(entity);
+	});
+
+	// Destroy() only marks entities as zombies, so Exists() already returns false for them. Now every store gets
+	// to evict them in a single pass, after which nobody holds their data and the slots can go back to the pool.
+	// Handles to them stay dead for good, because releasing a slot bumps its generation.
+
+	if(_Zombies.empty())
+		return;
 
-	// Destroy() adds those entities to the ZombieList, where they will be stored for one frame. Entities on the
-	// ZombieList return false if queried via EntityManager::Exists() which gives the ECS managers one frame to evict
-	// the data related to that entity before the entityID is returned to the pool, ready to be reused.
+	const DestroyedEntities destroyed(_Zombies, _ZombieBits);
+	for(auto* store : _Stores)
+	{
+		store->RemoveDestroyed(destroyed);
+	}
 
-	for(uint16_t i = 0; i < _PrevZombieCount; ++i)
+	for(const auto& entity : _Zombies)
 	{
-		DestroyZombies(ZombieList.Dequeue().value());
+		ReleaseZombie(entity);
 	}
-	_PrevZombieCount = _ZombieCount;
-	_ZombieCount     = 0;
+	_Zombies.clear();
+}
+
+void
+EntityManager::RegisterStore(ComponentStore& store)
+{
+	_Stores.push_back(&store);
 }
 
 uint32_t
 EntityManager::Count()
 {
-	uint32_t count = _OpenRanges[0].Begin - 1;
-
-	for(auto i = 1; i < _OpenRanges.size(); ++i)
-	{
-		const auto previous = _OpenRanges[i - 1];
-		const auto current  = _OpenRanges[i];
-
-		count += current.Begin - previous.End - 1;
-	}
-
-	return count;
+	return _Count;
 }
 
 void
 EntityManager::Clear()
 {
-	ZombieList.Clear();
-
-	//@TODO: Pretty clear that this range-based storage system needs to be it's own class.
-	_OpenRanges.clear();
-	_OpenRanges.push_back({ 1, Entity::EID_MAX });
+	_Zombies.clear();
+	std::fill(_ZombieBits.begin(), _ZombieBits.end(), 0);
+
+	// Every slot goes back into the pool with a fresh generation, so handles that outlive the clear
+	// (states holding on to entities, for example) can never alias whatever gets created next.
+	_FreeHead = 0;
+	_FreeTail = 0;
+	for(size_t i = 1; i < _Slots.size(); ++i)
+	{
+		auto& slot = _Slots[i];
+		slot.IsZombie = false;
+		++slot.Generation;
+		slot.NextFree   = 0;
+		slot.DeathTimer = DeathRow::Handle();
+
+		const auto index = static_cast<Entity::EID>(i);
+		if(_FreeTail != 0)
+			_Slots[_FreeTail].NextFree = index;
+		else
+			_FreeHead = index;
+		_FreeTail = index;
+	}
+	_Count = 0;
 
-	_DeathRow = DeathRow();
+	_DeathRow.Clear();
 }
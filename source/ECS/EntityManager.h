@@ -1,9 +1,10 @@
 #pragma once
 
-#include <queue>
+#include <vector>
 #include <iterator>
 
-#include "../Platform/RingBuffer.h"
+#include "../Platform/TimingWheel.h"
+#include "ComponentStore.h"
 #include "Entity.h"
 
 class Timer;
@@ -17,55 +18,61 @@ public:
 	Entity Create();
 	bool Exists(Entity entity) const;
 	void Destroy(Entity entity);
+	// Schedules the entity to be destroyed after `seconds`. Scheduling again replaces the previous timer, and
+	// destroying the entity early cancels it.
 	void DestroyDelayed(Entity entity, const float& seconds);
 
+	// Appends `count` new entities to `out`. Recycled slots are used first, then the slot table grows once
+	// for the remainder. Stops early (and asserts) if the entity limit is reached.
+	void CreateBatch(size_t count, std::vector<Entity>& out);
+	void DestroyBatch(const Entity* entities, size_t count);
+
+	// Registered stores are told about every destroyed entity, once, during GarbageCollect().
+	void RegisterStore(ComponentStore& store);
+
+	// Runs death row, hands this frame's zombies to every registered store, then returns their slots to the pool.
 	void GarbageCollect();
 
 	uint32_t Count();
 	void Clear();
 
-	RingBuffer<Entity> ZombieList;
-
 private:
-	void DestroyZombies(Entity entity);
+	void ReleaseZombie(Entity entity);
+	void CancelDeathTimer(Entity::EID index);
 
 	const Timer& _Time;
 
-	struct IDRange
+	// Every EID is a slot. A handle is only valid while its generation matches the slot's generation, and
+	// the generation is bumped when the slot is returned to the pool, so stale handles simply stop existing.
+	using DeathRow = TimingWheel<Entity>;
+
+	struct Slot
 	{
-		Entity::EID Begin;
-		Entity::EID End;
+		Entity::Generation Generation = 0;
+		bool IsZombie                 = false;
+		Entity::EID NextFree          = 0;
+		DeathRow::Handle DeathTimer;
 	};
 
-	uint_fast16_t _PrevZombieCount = 0;
-	uint_fast16_t _ZombieCount     = 0;
+	std::vector<Slot> _Slots;
 
-	std::vector<IDRange> _OpenRanges;
+	// Intrusive FIFO of released slots, threaded through Slot::NextFree. Zero means empty, because slot
+	// zero is the null entity and is never handed out. FIFO order keeps a recently destroyed ID out of
+	// circulation for as long as possible, which keeps generation wrap-around a non-issue.
+	Entity::EID _FreeHead = 0;
+	Entity::EID _FreeTail = 0;
 
-	class DeathRow
-		: public std::priority_queue<std::pair<float, Entity>,
-		                             std::vector<std::pair<float, Entity>>,
-		                             std::greater<std::pair<float, Entity>>>
-	{
-	public:
-		// ReSharper disable once CppInconsistentNaming
-		bool remove(const Entity entity)
-		{
-			const auto it = std::find_if(c.begin(), c.end(),
-			                             [=](std::pair<float, Entity> pair)
-			                             {
-				                             return pair.second == entity;
-			                             });
-
-			if(it != c.end())
-			{
-				c.erase(it);
-				std::make_heap(c.begin(), c.end(), this->comp);
-				return true;
-			}
-			return false;
-		}
-	};
+	uint32_t _Count = 0;
+
+	// Entities destroyed since the last GarbageCollect(), plus the same set as a bitset indexed by slot.
+	std::vector<Entity> _Zombies;
+	std::vector<uint64_t> _ZombieBits;
+
+	std::vector<ComponentStore*> _Stores;
+
+	// Delayed destruction is quantised to this many seconds. Lifetimes are short and cosmetic, so firing up
+	// to one tick late is fine.
+	static constexpr float DEATH_ROW_TICK = 1.0f / 128.0f;
 
 	DeathRow _DeathRow;
 };
@@ -1,84 +1,72 @@
-#include "EntityManager.h"
 #include "RigidbodyManager.h"
 #include "../Physics/Physics.h"
 
-RigidbodyManager::RigidbodyManager(const EntityManager& entityManager, const int capacity)
-	: _EntityManager(entityManager)
+RigidbodyManager::RigidbodyManager(BodyArchetype& bodies, const int capacity)
+	: _Columns(capacity),
+	  _Bodies(bodies)
 {
-	Allocate(capacity);
 }
 
 void
 RigidbodyManager::Add(const Entity& entity, const ColliderType colliderType, const Vector2 velocity, const float rotVelocity)
 {
-	if(_Size == _Capacity)
-	{
-		// We're about to overrun our buffer, we gotta scale.
-		Allocate((_Size * 2));
-	}
-
-	// Insert our data at the back of the data store
 	Rigidbody rb;
 	rb.entity          = entity; // @TODO: duplicate storage, clean up?
 	rb.velocity        = velocity;
 	rb.colliderType    = colliderType;
 	rb.angularVelocity = rotVelocity;
 
-	*(_Entities + _Size)    = entity;
-	*(_Rigidbodies + _Size) = rb;
-
-	++_Size;
+	AddBatch(&rb, 1);
 }
 
 void
-RigidbodyManager::Allocate(const int capacity)
+RigidbodyManager::AddBatch(const Rigidbody* rigidbodies, const size_t count)
 {
-	_Capacity = capacity;
-
-	// Allocate new memory
-	const auto elementSizeInBytes = sizeof(Entity) + sizeof(Rigidbody);
-	void* newBuffer               = new size_t[(elementSizeInBytes * capacity)];
-
-	// Set up new pointers for where our data will go
-	const auto newEntities    = static_cast<Entity*>(newBuffer);
-	const auto newRigidbodies = reinterpret_cast<Rigidbody*>(newEntities + capacity);
+	_Columns.Reserve(_Columns.Size() + count);
 
-	if(_Size > 0)
+	for(size_t i = 0; i < count; ++i)
 	{
-		// Copy the data to the new buffer
-		memcpy(newEntities, _Entities, sizeof(Entity) * _Size);
-		memcpy(newRigidbodies, _Rigidbodies, sizeof(Rigidbody) * _Size);
-	}
+		const auto& rb = rigidbodies[i];
 
-	// Switch the pointers around
-	_Entities    = newEntities;
-	_Rigidbodies = newRigidbodies;
+		size_t existing;
+		if(Lookup(rb.entity, &existing))
+		{
+			// Re-adding an entity just overwrites its rigidbody.
+			_Columns.Column<RIGIDBODIES>()[existing] = rb;
+			continue;
+		}
 
-	// Switch the buffers and free the old memory
-	// ReSharper disable once CppDeletingVoidPointer
-	delete _Buffer;
-	_Buffer = newBuffer;
+		const auto index = _Columns.PushBack(rb.entity, rb);
+		SetIndex(rb.entity, static_cast<uint32_t>(index));
+	}
 }
 
 bool
 RigidbodyManager::Lookup(const Entity entity, size_t* index) const
 {
-	auto entityIndex = _Entities;
-	size_t i         = 0;
-	for(; i < _Size; ++i, ++entityIndex)
+	const auto slot = entity.Index();
+	if(slot >= _Sparse.size())
+		return false;
+
+	const auto denseIndex = _Sparse[slot];
+
+	// The slot may belong to a stale entity from a previous generation, so confirm ownership.
+	if(denseIndex == INVALID_INDEX || _Columns.Column<ENTITIES>()[denseIndex] != entity)
+		return false;
+
+	*index = denseIndex;
+	return true;
+}
+
+void
+RigidbodyManager::SetIndex(const Entity entity, const uint32_t index)
+{
+	const auto slot = entity.Index();
+	if(slot >= _Sparse.size())
 	{
-		if(*entityIndex == Entity::Null())
-		{
-			// We hit the end of the index! This entity wasn't in the store!
-			return false;
-		}
-		if(*entityIndex == entity)
-		{
-			*index = i;
-			return true;
-		}
+		_Sparse.resize(static_cast<size_t>(slot) + 1, INVALID_INDEX);
 	}
-	return false;
+	_Sparse[slot] = index;
 }
 
 bool
@@ -87,10 +75,12 @@ RigidbodyManager::GetMutable(const Entity entity, Rigidbody*& rb)
 	size_t index;
 	if(Lookup(entity, &index))
 	{
-		rb = (_Rigidbodies + index);
+		rb = &_Columns.Column<RIGIDBODIES>()[index];
 		return true;
 	}
-	return false;
+
+	rb = _Bodies.Get<Rigidbody>(entity);
+	return rb != nullptr;
 }
 
 std::optional<Rigidbody>
@@ -100,7 +90,11 @@ RigidbodyManager::Get(const Entity entity) const
 	size_t index;
 	if(Lookup(entity, &index))
 	{
-		result = *(_Rigidbodies + index);
+		result = _Columns.Column<RIGIDBODIES>()[index];
+	}
+	else if(const auto* bodyRb = _Bodies.Get<Rigidbody>(entity))
+	{
+		result = *bodyRb;
 	}
 	return result;
 }
@@ -108,41 +102,58 @@ RigidbodyManager::Get(const Entity entity) const
 uint32_t
 RigidbodyManager::Count() const
 {
-	return _Size;
+	return static_cast<uint32_t>(_Columns.Size());
 }
 
 void
 RigidbodyManager::Clear()
 {
-	_Size = 0;
+	_Columns.Clear();
+	_Sparse.clear();
 }
 
 
 void
-RigidbodyManager::EnqueueAll(Physics& physics, const float& deltaTime)
+RigidbodyManager::RemoveDestroyed(const DestroyedEntities& destroyed)
 {
-	auto i = 0;
-	while(i < _Size)
+	for(const auto& entity : destroyed)
 	{
-		const auto entity = (_Entities + i);
-		const auto rb     = (_Rigidbodies + i);
+		Remove(entity);
+	}
+}
 
-		if(_EntityManager.Exists(*entity))
-		{
-			physics.Enqueue(*rb, deltaTime);
-			++i;
-		}
-		else
-		{
-			// Transform appears to have been deleted.
-			// Do the swap to remove it from the list.
-			const auto lastActiveEntity    = _Entities + _Size - 1;
-			const auto lastActiveRigidbody = _Rigidbodies + _Size - 1;
+void
+RigidbodyManager::Remove(const Entity entity)
+{
+	size_t index;
+	if(!Lookup(entity, &index))
+		return;
 
-			*(_Entities + i)    = *(lastActiveEntity);
-			*(_Rigidbodies + i) = *(lastActiveRigidbody);
+	// Swap the last row into the hole, then fix up the moved entity's sparse entry.
+	const auto last = _Columns.Size() - 1;
+	_Columns.SwapRemove(index);
 
-			--_Size;
-		}
+	_Sparse[entity.Index()] = INVALID_INDEX;
+	if(index != last)
+		SetIndex(_Columns.Column<ENTITIES>()[index], static_cast<uint32_t>(index));
+}
+
+void
+RigidbodyManager::EnqueueAll(Physics& physics, const float& deltaTime)
+{
+	// Dead entities are evicted during garbage collection, so everything in here is alive.
+	for(const auto& rb : _Columns.Column<RIGIDBODIES>())
+	{
+		physics.Enqueue(rb, deltaTime);
 	}
+
+	// Bodies carry their transform alongside the rigidbody, so this is a straight stream through each chunk.
+	_Bodies.Query<Transform, Rigidbody>(
+		[&](const size_t count, const Entity*, const Transform* transforms, const Rigidbody* rigidbodies)
+		{
+			for(size_t row = 0; row < count; ++row)
+			{
+				physics.Enqueue(rigidbodies[row], transforms[row], deltaTime);
+			}
+		});
 }
@@ -1,40 +1,50 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 
 #include "../Math/Vector2.h"
 
+#include "BodyArchetype.h"
+#include "ComponentColumns.h"
+#include "ComponentStore.h"
 #include "Entity.h"
 #include "Rigidbody.h"
 
 #include "../Physics/ColliderType.h"
 
-class EntityManager;
 class Physics;
 
-class RigidbodyManager
+class RigidbodyManager final : public ComponentStore
 {
 public:
-	RigidbodyManager(const EntityManager& entityManager, int capacity);
-
-	void Allocate(int capacity);
+	RigidbodyManager(BodyArchetype& bodies, int capacity);
 
 	void EnqueueAll(Physics& physics, const float& deltaTime);
 	void Add(const Entity& entity, ColliderType colliderType, Vector2 velocity, float rotVelocity);
+	void AddBatch(const Rigidbody* rigidbodies, size_t count);
 	bool Lookup(Entity entity, size_t* index) const;
 
+	// Both fall back to the body archetype for entities stored there.
 	bool GetMutable(Entity entity, Rigidbody*& rb);
 	std::optional<Rigidbody> Get(Entity entity) const;
 
+	void RemoveDestroyed(const DestroyedEntities& destroyed) override;
+
 	uint32_t Count() const;
 	void Clear();
 private:
-	int _Size = 0;
-	int _Capacity;
+	void Remove(Entity entity);
+	void SetIndex(Entity entity, uint32_t index);
+
+	static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+	enum Column : size_t { ENTITIES, RIGIDBODIES };
+	ComponentColumns<Entity, Rigidbody> _Columns;
 
-	void* _Buffer;
-	Entity* _Entities;
-	Rigidbody* _Rigidbodies;
+	// Indexed by Entity::Index(), points at the entity's row in _Columns.
+	// Kept in sync by Add and by the swap-remove in Remove.
+	std::vector<uint32_t> _Sparse;
 
-	const EntityManager& _EntityManager;
+	BodyArchetype& _Bodies;
 };
@@ -1,29 +1,31 @@
+#include <algorithm>
 #include <iostream>
 
 #include "SpriteManager.h"
 
 
-#include "EntityManager.h"
 #include "../Renderer/Sprite.h"
 #include "../Renderer/RenderQueue.h"
 #include "../Renderer/SpriteTransform.h"
 
 
-SpriteManager::SpriteManager(const TransformManager& transManager,
-                             const EntityManager& entityManager,
+SpriteManager::SpriteManager(TransformManager& transManager,
+                             BodyArchetype& bodies,
                              const SpriteAtlas& spriteAtlas,
                              const int capacity)
 	: _TransManager(transManager),
+	  _Bodies(bodies),
 	  _SpriteAtlas(spriteAtlas),
-	  _Repeating(transManager, entityManager, capacity),
-	  _NonRepeating(transManager, entityManager, capacity),
-	  _ScreenSpace(transManager, entityManager, capacity)
+	  _Repeating(transManager, capacity),
+	  _NonRepeating(transManager, capacity),
+	  _ScreenSpace(transManager, capacity)
 {
 }
 
 void
 SpriteManager::Render(RenderQueue& renderQueue) const
 {
+	RenderBodies(renderQueue);
 	_Repeating.RenderLooped(renderQueue);
 	_NonRepeating.RenderScreenSpace(renderQueue);
 	_ScreenSpace.RenderScreenSpace(renderQueue);
@@ -45,7 +47,16 @@ SpriteManager::Create(const Entity entity,
 			"before calling Create on an entity, please make sure you always make the transform first!");
 	}
 
-	const auto [TransPos, TransRot] = transOpt.value();
+	Create(entity, MakeSpriteTransform(transOpt.value(), spriteID, layer, scale), renderFlags);
+}
+
+SpriteTransform
+SpriteManager::MakeSpriteTransform(const Transform& trans,
+                                   const SpriteID spriteID,
+                                   const RenderQueue::Layer layer,
+                                   const float scale) const
+{
+	const auto [TransPos, TransRot] = trans;
 
 	const auto [id, tex, rect] = _SpriteAtlas.Get(spriteID);
 
@@ -65,7 +76,7 @@ SpriteManager::Create(const Entity entity,
 	spriteTransform.Rotation = TransRot;
 	spriteTransform.Layer    = layer;
 
-	Create(entity, spriteTransform, renderFlags);
+	return spriteTransform;
 }
 
 void
@@ -92,12 +103,70 @@ SpriteManager::Create(const Entity entity, const SpriteTransform& spriteTransfor
 	}
 }
 
+void
+SpriteManager::CreateBatch(const Entity* entities,
+                           const SpriteTransform* spriteTransforms,
+                           const size_t count,
+                           const RenderFlags renderFlags)
+{
+	switch(renderFlags)
+	{
+		case RenderFlags::FIXED:
+		{
+			_NonRepeating.CreateBatch(entities, spriteTransforms, count);
+			break;
+		}
+		case RenderFlags::REPEATING:
+		{
+			_Repeating.CreateBatch(entities, spriteTransforms, count);
+			break;
+		}
+		case RenderFlags::SCREEN_SPACE:
+		{
+			_ScreenSpace.CreateBatch(entities, spriteTransforms, count);
+			break;
+		}
+	}
+}
+
 void
 SpriteManager::Update(const float deltaTime)
 {
+	UpdateBodies(deltaTime);
 	_Repeating.Update(_SpriteAtlas, deltaTime);
 	_NonRepeating.Update(_SpriteAtlas, deltaTime);
 	_ScreenSpace.Update(_SpriteAtlas, deltaTime);
+
+	SyncChanged();
+}
+
+void
+SpriteManager::SyncChanged()
+{
+	for(const auto& entity : _TransManager.Changed())
+	{
+		const auto transform = _TransManager.Get(entity);
+		if(!transform.has_value())
+			continue;
+
+		// An entity only has a sprite in one category, the others miss on a sparse lookup.
+		_Repeating.Sync(entity, transform.value());
+		_NonRepeating.Sync(entity, transform.value());
+		_ScreenSpace.Sync(entity, transform.value());
+	}
+
+	//@NOTE: We're the only consumer of the change list. Anything that moves later this frame gets synced next frame,
+	// same as when we synced everything.
+	_TransManager.ClearChanged();
+}
+
+void
+SpriteManager::RemoveDestroyed(const DestroyedEntities& destroyed)
+{
+	// Bodies are evicted by the archetype itself.
+	_Repeating.RemoveDestroyed(destroyed);
+	_NonRepeating.RemoveDestroyed(destroyed);
+	_ScreenSpace.RemoveDestroyed(destroyed);
 }
 
 void
@@ -109,159 +178,223 @@ SpriteManager::Clear()
 }
 
 
-// SPRITE CATEGORY
-
-SpriteManager::SpriteCategory::SpriteCategory(const TransformManager& transManager, const EntityManager& entityManager, const int capacity)
-	: _TransManager(transManager),
-	  _EntityManager(entityManager)
+bool
+SpriteManager::Animate(const SpriteAtlas& spriteAtlas, SpriteTransform& spriteTrans, float& frameTime, const float deltaTime)
 {
-	Allocate(capacity);
+	frameTime -= deltaTime;
+	if(frameTime >= 0.0f)
+		return false;
+
+	spriteTrans.ID = SpriteAnimationData::NEXT_FRAME_INDEX[static_cast<int>(spriteTrans.ID)];
+	frameTime += SpriteAnimationData::FRAME_TIME[static_cast<int>(spriteTrans.ID)];
+
+	const auto [spriteID, tex, src] = spriteAtlas.Get(spriteTrans.ID);
+	spriteTrans.Position.w          = src.w;
+	spriteTrans.Position.h          = src.h;
+	return true;
 }
 
 void
-SpriteManager::SpriteCategory::Allocate(const int newCapacity)
+SpriteManager::SyncToTransform(SpriteTransform& spriteTrans, const Transform& transform)
 {
-	_Capacity = newCapacity;
+	spriteTrans.Rotation   = transform.rot;
+	spriteTrans.Position.x = static_cast<int>(floor(transform.pos.x - static_cast<float>(spriteTrans.Position.w) / 2.0f));
+	spriteTrans.Position.y = static_cast<int>(floor(transform.pos.y - static_cast<float>(spriteTrans.Position.h) / 2.0f));
+}
 
-	// Allocate new memory
-	const auto elementSizeInBytes = sizeof(Entity) + sizeof(SpriteTransform);
-	void* newBuffer               = new size_t[(elementSizeInBytes * newCapacity)];
 
-	// Set up new pointers for where our data will go
-	Entity* newEntities            = static_cast<Entity*>(newBuffer);
-	SpriteTransform* newTransforms = reinterpret_cast<SpriteTransform*>(newEntities + newCapacity);
+// BODIES
 
-	if(_Size > 0)
-	{
-		// Copy the data to the new buffer
-		memcpy(newEntities, _Entities, sizeof(Entity) * _Size);
-		memcpy(newTransforms, _Transforms, sizeof(SpriteTransform) * _Size);
-	}
+void
+SpriteManager::UpdateBodies(const float deltaTime)
+{
+	// One linear pass per chunk. No per-entity lookups: the transform sits right next to the sprite.
+	_Bodies.Query<Transform, SpriteTransform, SpriteFrameTimer>(
+		[&](const size_t count,
+		    const Entity*,
+		    const Transform* transforms,
+		    SpriteTransform* spriteTransforms,
+		    SpriteFrameTimer* frameTimers)
+		{
+			for(size_t i = 0; i < count; ++i)
+			{
+				auto& spriteTrans = spriteTransforms[i];
+				if(spriteTrans.ID == SpriteID::NONE)
+					continue;
 
-	// Switch the pointers around
-	_Entities   = newEntities;
-	_Transforms = newTransforms;
+				if(SpriteAtlas::IsAnimated(spriteTrans.ID))
+				{
+					Animate(_SpriteAtlas, spriteTrans, frameTimers[i].Remaining, deltaTime);
+				}
 
-	// Switch the buffers and free the old memory
-	// ReSharper disable once CppDeletingVoidPointer
-	delete _Buffer;
-	_Buffer = newBuffer;
+				SyncToTransform(spriteTrans, transforms[i]);
+			}
+		});
+}
+
+void
+SpriteManager::RenderBodies(RenderQueue& renderQueue) const
+{
+	_Bodies.Query<SpriteTransform>(
+		[&](const size_t count, const Entity*, const SpriteTransform* spriteTransforms)
+		{
+			for(size_t i = 0; i < count; ++i)
+			{
+				if(spriteTransforms[i].ID != SpriteID::NONE)
+					renderQueue.EnqueueLooped(spriteTransforms[i]);
+			}
+		});
 }
 
 
+// SPRITE CATEGORY
+
+SpriteManager::SpriteCategory::SpriteCategory(const TransformManager& transManager, const int capacity)
+	: _TransManager(transManager),
+	  _Columns(capacity)
+{
+}
+
 void
 SpriteManager::SpriteCategory::RenderScreenSpace(RenderQueue& renderQueue) const
 {
-	for(auto i = 0; i < _Size; i++)
+	for(const auto& transform : _Columns.Column<TRANSFORMS>())
 	{
-		const SpriteTransform* transform = _Transforms + i;
-		renderQueue.EnqueueScreenSpace(transform->ID, transform->Position, transform->Rotation, transform->Layer);
+		renderQueue.EnqueueScreenSpace(transform.ID, transform.Position, transform.Rotation, transform.Layer);
 	}
 }
 
 void
 SpriteManager::SpriteCategory::RenderLooped(RenderQueue& renderQueue) const
 {
-	for(auto i = 0; i < _Size; i++)
+	for(const auto& transform : _Columns.Column<TRANSFORMS>())
 	{
-		const SpriteTransform* transform = _Transforms + i;
-		renderQueue.EnqueueLooped(*transform);
+		renderQueue.EnqueueLooped(transform);
 	}
 }
 
 void
 SpriteManager::SpriteCategory::Clear()
 {
-	_Size         = 0;
-	_AnimatedSize = 0;
+	_Columns.Clear();
+	_CurrentFrameTimes.clear();
+	_Sparse.clear();
+}
+
+bool
+SpriteManager::SpriteCategory::Lookup(const Entity entity, size_t* row) const
+{
+	const auto slot = entity.Index();
+	if(slot >= _Sparse.size())
+		return false;
+
+	const auto found = _Sparse[slot];
+
+	// The slot may belong to a stale entity from a previous generation, so confirm ownership.
+	if(found == INVALID_ROW || found >= _Columns.Size() || _Columns.Column<ENTITIES>()[found] != entity)
+		return false;
+
+	*row = found;
+	return true;
+}
+
+void
+SpriteManager::SpriteCategory::Reindex(const size_t row)
+{
+	if(row < _Columns.Size())
+		_Sparse[_Columns.Column<ENTITIES>()[row].Index()] = static_cast<uint32_t>(row);
 }
 
 void
 SpriteManager::SpriteCategory::Create(const Entity entity, const SpriteID spriteID, const SpriteTransform trans)
 {
-	if(_Size == _Capacity)
+	// Insert our data at the back of the data store. The store scales itself if we're about to overrun it.
+	const auto index = _Columns.PushBack(entity, trans);
+
+	const auto slot = entity.Index();
+	if(slot >= _Sparse.size())
 	{
-		// We're about to overrun our buffer, we gotta scale.
-		Allocate(static_cast<size_t>(_Size * 2));
+		_Sparse.resize(static_cast<size_t>(slot) + 1, INVALID_ROW);
 	}
-
-	// Insert our data at the back of the data store
-	*(_Entities + _Size)   = entity;
-	*(_Transforms + _Size) = trans;
+	_Sparse[slot] = static_cast<uint32_t>(index);
 
 	if(SpriteAtlas::IsAnimated(spriteID))
 	{
-		// @TODO: This isn't the most efficient algorithm but I'm assuming the compiler will fix it..?
-		std::swap(*(_Entities + _Size), *(_Entities + _CurrentFrameTimes.size()));
-		std::swap(*(_Transforms + _Size), *(_Transforms + _CurrentFrameTimes.size()));
+		// Move it down to the end of the animated block.
+		const auto animatedEnd = _CurrentFrameTimes.size();
+		_Columns.Swap(index, animatedEnd);
+		Reindex(index);
+		Reindex(animatedEnd);
 
 		_CurrentFrameTimes.push_back(SpriteAnimationData::FRAME_TIME[static_cast<int>(spriteID)]);
 	}
+}
+
+void
+SpriteManager::SpriteCategory::CreateBatch(const Entity* entities, const SpriteTransform* spriteTransforms, const size_t count)
+{
+	// Grow once for the whole batch. Animated sprites still need slotting into the animated block one by one.
+	_Columns.Reserve(_Columns.Size() + count);
+	if(_CurrentFrameTimes.size() + count > _CurrentFrameTimes.capacity())
+		_CurrentFrameTimes.reserve(std::max(_CurrentFrameTimes.size() + count, _CurrentFrameTimes.capacity() * 2));
 
-	++_Size;
+	for(size_t i = 0; i < count; ++i)
+	{
+		Create(entities[i], spriteTransforms[i].ID, spriteTransforms[i]);
+	}
 }
 
 void
 SpriteManager::SpriteCategory::Update(const SpriteAtlas& spriteAtlas, const float deltaTime)
 {
-	auto i = 0;
-	while(i < _Size)
+	// Animated sprites sit at the front, so static ones are never visited.
+	for(size_t i = 0; i < _CurrentFrameTimes.size(); ++i)
 	{
-		const auto entity = (_Entities + i);
-		auto spriteTrans  = (_Transforms + i);
+		auto& spriteTrans = _Columns.Column<TRANSFORMS>()[i];
+		if(!Animate(spriteAtlas, spriteTrans, _CurrentFrameTimes[i], deltaTime))
+			continue;
+
+		// A new frame can be a different size, which moves the top left corner even if the transform stayed put.
+		const auto transform = _TransManager.Get(_Columns.Column<ENTITIES>()[i]);
+		if(transform.has_value())
+			SyncToTransform(spriteTrans, transform.value());
+	}
+}
 
-		auto transform = _TransManager.Get(*entity);
-		if(_EntityManager.Exists(*entity) && transform.has_value())
-		{
-			if(SpriteAtlas::IsAnimated(spriteTrans->ID))
-			{
-				_CurrentFrameTimes[i] -= deltaTime;
-				if(_CurrentFrameTimes[i] < 0.0f)
-				{
-					spriteTrans->ID = SpriteAnimationData::NEXT_FRAME_INDEX[static_cast<int>(spriteTrans->ID)];
-					_CurrentFrameTimes[i] += SpriteAnimationData::FRAME_TIME[static_cast<int>(spriteTrans->ID)];
+void
+SpriteManager::SpriteCategory::Sync(const Entity entity, const Transform& transform)
+{
+	size_t row;
+	if(Lookup(entity, &row))
+		SyncToTransform(_Columns.Column<TRANSFORMS>()[row], transform);
+}
 
-					const auto [spriteID, tex, src] = spriteAtlas.Get(spriteTrans->ID);
-					spriteTrans->Position.w         = src.w;
-					spriteTrans->Position.h         = src.h;
-				}
-			}
+void
+SpriteManager::SpriteCategory::RemoveDestroyed(const DestroyedEntities& destroyed)
+{
+	for(const auto& entity : destroyed)
+	{
+		size_t i;
+		if(!Lookup(entity, &i))
+			continue;
 
-			spriteTrans->Rotation   = transform.value().rot;
-			spriteTrans->Position.x = static_cast<int>(floor(transform.value().pos.x - static_cast<float>(spriteTrans->Position.w) / 2.0f));
-			spriteTrans->Position.y = static_cast<int>(floor(transform.value().pos.y - static_cast<float>(spriteTrans->Position.h) / 2.0f));
+		// Do the swap to remove it from the list.
+		size_t swapTarget = i;
 
-			++i;
-		}
-		else
+		if(SpriteAtlas::IsAnimated(_Columns.Column<TRANSFORMS>()[i].ID))
 		{
-			// Entity or Transform appears to have been deleted.
-			// Do the swap to remove it from the list.
-
-			const auto lastEntity    = _Entities + _Size - 1;
-			const auto lastTransform = _Transforms + _Size - 1;
-
-			size_t swapTarget = i;
-
-			if(SpriteAtlas::IsAnimated(spriteTrans->ID))
-			{
-				// Maintain sorted order for animated sprites
-				swapTarget = _CurrentFrameTimes.size() - 1;
-
-				Entity* lastAnimatedEntity             = _Entities + swapTarget;
-				SpriteTransform* lastAnimatedTransform = _Transforms + swapTarget;
-
-				*(_Entities + i)   = *(lastAnimatedEntity);
-				*(_Transforms + i) = *(lastAnimatedTransform);
+			// Maintain sorted order for animated sprites
+			swapTarget = _CurrentFrameTimes.size() - 1;
 
-				_CurrentFrameTimes[i] = _CurrentFrameTimes.back();
-				_CurrentFrameTimes.pop_back();
-			}
-
-			*(_Entities + swapTarget)   = *(lastEntity);
-			*(_Transforms + swapTarget) = *(lastTransform);
+			_Columns.Swap(i, swapTarget);
+			Reindex(i);
 
-			--_Size;
+			_CurrentFrameTimes[i] = _CurrentFrameTimes.back();
+			_CurrentFrameTimes.pop_back();
 		}
+
+		_Columns.SwapRemove(swapTarget);
+		Reindex(swapTarget);
+		_Sparse[entity.Index()] = INVALID_ROW;
 	}
 }
@@ -1,16 +1,20 @@
 #pragma once
 
+#include "BodyArchetype.h"
+#include "ComponentColumns.h"
+#include "ComponentStore.h"
 #include "Entity.h"
 
 #include "../Renderer/RenderQueue.h"
 #include "../Renderer/SpriteAtlas.h"
+#include "../Renderer/SpriteTransform.h"
 
 
 #include "TransformManager.h"
 
 class AABB;
 
-class SpriteManager
+class SpriteManager final : public ComponentStore
 {
 public:
 	enum class RenderFlags : uint8_t
@@ -20,33 +24,51 @@ public:
         SCREEN_SPACE,
     };
 
-	SpriteManager(const TransformManager& transManager, const EntityManager& entityManager, const SpriteAtlas& spriteAtlas, int capacity);
+	SpriteManager(TransformManager& transManager, BodyArchetype& bodies, const SpriteAtlas& spriteAtlas, int capacity);
 	SpriteManager() = delete;
 
+	SpriteTransform MakeSpriteTransform(const Transform& trans, SpriteID spriteID, RenderQueue::Layer layer, float scale = 1.0f) const;
+
 	void Create(Entity entity, SpriteID spriteID, RenderQueue::Layer layer, float scale = 1.0f, RenderFlags renderFlags = RenderFlags::REPEATING);
 	void Create(Entity entity, const SpriteTransform& spriteTransform, RenderFlags renderFlags);
+	void CreateBatch(const Entity* entities, const SpriteTransform* spriteTransforms, size_t count, RenderFlags renderFlags);
 
 	void Render(RenderQueue& renderQueue) const;
 
 	void Update(float deltaTime);
 
+	void RemoveDestroyed(const DestroyedEntities& destroyed) override;
+
 	void Clear();
 
 private:
-	const TransformManager& _TransManager;
+	// Returns true if the sprite moved on to a new frame, which may have changed its size.
+	static bool Animate(const SpriteAtlas& spriteAtlas, SpriteTransform& spriteTrans, float& frameTime, float deltaTime);
+	static void SyncToTransform(SpriteTransform& spriteTrans, const Transform& transform);
+
+	void UpdateBodies(float deltaTime);
+	void RenderBodies(RenderQueue& renderQueue) const;
+
+	// Brings sprites in line with every transform that changed since the last sync, and nothing else.
+	void SyncChanged();
+
+	TransformManager& _TransManager;
+	BodyArchetype& _Bodies;
 
 	class SpriteCategory
 	{
 	public:
 
-		SpriteCategory(const TransformManager& transManager, const EntityManager& entityManager, int capacity);
+		SpriteCategory(const TransformManager& transManager, int capacity);
 		SpriteCategory() = delete;
 
-		void Allocate(int newCapacity);
-
 		void Create(Entity entity, SpriteID spriteID, SpriteTransform trans);
+		void CreateBatch(const Entity* entities, const SpriteTransform* spriteTransforms, size_t count);
 
+		// Only animated sprites are touched here. Movement is picked up by Sync.
 		void Update(const SpriteAtlas& spriteAtlas, float deltaTime);
+		void Sync(Entity entity, const Transform& transform);
+		void RemoveDestroyed(const DestroyedEntities& destroyed);
 
 		void RenderScreenSpace(RenderQueue& renderQueue) const;
 		void RenderLooped(RenderQueue& renderQueue) const;
@@ -54,18 +76,23 @@ private:
 		void Clear();
 
 	private:
-		const TransformManager& _TransManager;
-		const EntityManager& _EntityManager;
+		static constexpr uint32_t INVALID_ROW = UINT32_MAX;
+
+		bool Lookup(Entity entity, size_t* row) const;
 
-		int _Size         = 0;
-		int _AnimatedSize = 0;
-		int _Capacity;
+		// Points the sparse entry of whoever now sits in `row` back at it, after a swap.
+		void Reindex(size_t row);
 
-		void* _Buffer;
-		Entity* _Entities;
-		SpriteTransform* _Transforms;
+		const TransformManager& _TransManager;
+
+		// Animated sprites are kept at the front of the store, in the same order as _CurrentFrameTimes.
+		enum Column : size_t { ENTITIES, TRANSFORMS };
+		ComponentColumns<Entity, SpriteTransform> _Columns;
 
 		std::vector<float> _CurrentFrameTimes;
+
+		// Indexed by Entity::Index(), holds the entity's row in _Columns.
+		std::vector<uint32_t> _Sparse;
 	};
 
 	const SpriteAtlas& _SpriteAtlas;
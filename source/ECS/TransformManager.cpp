@@ -1,23 +1,48 @@
+#include <algorithm>
 
 #include "TransformManager.h"
 #include "EntityManager.h"
 
 
-TransformManager::TransformManager(const int capacity)
+TransformManager::TransformManager(BodyArchetype& bodies, const int capacity)
+	: _Bodies(bodies)
 {
+	_Sparse.reserve(capacity);
+	_Entities.reserve(capacity);
 	_Transforms.reserve(capacity);
+	_IsChanged.reserve(capacity);
 }
 
+bool
+TransformManager::Lookup(const Entity entity, size_t* index) const
+{
+	const auto slot = entity.Index();
+	if(slot >= _Sparse.size())
+		return false;
+
+	const auto denseIndex = _Sparse[slot];
+
+	// The slot may be shared with a stale entity from a previous generation, so confirm ownership.
+	if(denseIndex == INVALID_INDEX || _Entities[denseIndex] != entity)
+		return false;
+
+	*index = denseIndex;
+	return true;
+}
 
 std::optional<Transform>
 TransformManager::Get(const Entity entity) const
 {
 	std::optional<Transform> result;
 
-	const auto Search = _Transforms.find(entity);
-
-	if (Search != _Transforms.end()) {
-		result = Search->second;
+	size_t index;
+	if(Lookup(entity, &index))
+	{
+		result = _Transforms[index];
+	}
+	else if(const auto* bodyTransform = _Bodies.Get<Transform>(entity))
+	{
+		result = *bodyTransform;
 	}
 	return result;
 }
@@ -26,10 +51,16 @@ std::optional<Transform*>
 TransformManager::GetMutable(const Entity entity)
 {
 	std::optional<Transform*> result;
-	auto Search = _Transforms.find(entity);
 
-	if (Search != _Transforms.end()) {
-		result = &Search->second;
+	size_t index;
+	if(Lookup(entity, &index))
+	{
+		MarkChanged(index);
+		result = &_Transforms[index];
+	}
+	else if(auto* bodyTransform = _Bodies.Get<Transform>(entity))
+	{
+		result = bodyTransform;
 	}
 	return result;
 }
@@ -37,14 +68,82 @@ TransformManager::GetMutable(const Entity entity)
 
 void TransformManager::Add(const Entity entity, const Transform transform)
 {
-	_Transforms.insert_or_assign(entity, transform);
+	const auto slot = entity.Index();
+	if(slot >= _Sparse.size())
+	{
+		_Sparse.resize(static_cast<size_t>(slot) + 1, INVALID_INDEX);
+	}
+
+	const auto denseIndex = _Sparse[slot];
+	if(denseIndex != INVALID_INDEX && _Entities[denseIndex].Index() == slot)
+	{
+		// Either this entity already has a transform, or a stale entity that shared the slot
+		// was never collected. Either way, we take over the existing dense element.
+		if(_Entities[denseIndex] != entity)
+		{
+			// The stale entity's change doesn't count for us, so make sure we get listed.
+			_IsChanged[denseIndex] = 0;
+		}
+
+		_Entities[denseIndex]   = entity;
+		_Transforms[denseIndex] = transform;
+		MarkChanged(denseIndex);
+		return;
+	}
+
+	_Sparse[slot] = static_cast<uint32_t>(_Transforms.size());
+	_Entities.push_back(entity);
+	_Transforms.push_back(transform);
+	_IsChanged.push_back(0);
+	MarkChanged(_Transforms.size() - 1);
+}
+
+void TransformManager::AddBatch(const Entity* entities, const Transform* transforms, const size_t count)
+{
+	// Grow once for the whole batch, then append as usual.
+	const auto required = _Transforms.size() + count;
+	if(required > _Transforms.capacity())
+	{
+		const auto capacity = std::max(required, _Transforms.capacity() * 2);
+		_Entities.reserve(capacity);
+		_Transforms.reserve(capacity);
+		_IsChanged.reserve(capacity);
+	}
+
+	for(size_t i = 0; i < count; ++i)
+	{
+		Add(entities[i], transforms[i]);
+	}
+}
+
+void TransformManager::Remove(const Entity entity)
+{
+	size_t index;
+	if(!Lookup(entity, &index))
+		return;
+
+	// Swap the last element into the hole and pop.
+	const auto lastIndex = _Transforms.size() - 1;
+	if(index != lastIndex)
+	{
+		_Entities[index]   = _Entities[lastIndex];
+		_Transforms[index] = _Transforms[lastIndex];
+		_IsChanged[index]  = _IsChanged[lastIndex];
+
+		_Sparse[_Entities[index].Index()] = static_cast<uint32_t>(index);
+	}
+
+	_Sparse[entity.Index()] = INVALID_INDEX;
+	_Entities.pop_back();
+	_Transforms.pop_back();
+	_IsChanged.pop_back();
 }
 
-void TransformManager::GarbageCollect(const EntityManager& entityManager)
+void TransformManager::RemoveDestroyed(const DestroyedEntities& destroyed)
 {
-	for(const auto& entity : entityManager.ZombieList)
+	for(const auto& entity : destroyed)
 	{
-		_Transforms.erase(entity);
+		Remove(entity);
 	}
 }
 
@@ -56,5 +155,32 @@ size_t TransformManager::Count() const
 void
 TransformManager::Clear()
 {
+	_Sparse.clear();
+	_Entities.clear();
 	_Transforms.clear();
+	_IsChanged.clear();
+	_Changed.clear();
+}
+
+void
+TransformManager::MarkChanged(const size_t index)
+{
+	if(_IsChanged[index])
+		return;
+
+	_IsChanged[index] = 1;
+	_Changed.push_back(_Entities[index]);
+}
+
+void
+TransformManager::ClearChanged()
+{
+	// Only touch the flags we set, so a frame where nothing moved costs nothing.
+	for(const auto& entity : _Changed)
+	{
+		size_t index;
+		if(Lookup(entity, &index))
+			_IsChanged[index] = 0;
+	}
+	_Changed.clear();
 }
@@ -1,25 +1,67 @@
 #pragma once
 
 #include <optional>
-#include <unordered_map>
+#include <vector>
 
+#include "BodyArchetype.h"
+#include "ComponentStore.h"
 #include "Transform.h"
 #include "Entity.h"
 
-class TransformManager
+class EntityManager;
+
+class TransformManager final : public ComponentStore
 {
 public:
-	explicit TransformManager(int capacity);
+	TransformManager(BodyArchetype& bodies, int capacity);
 
+	// Falls back to the body archetype for entities stored there.
 	std::optional<Transform> Get(Entity entity) const;
+
+	// Handing out a pointer into this store marks the transform as changed.
 	std::optional<Transform*> GetMutable(Entity entity);
 
 	void Add(Entity entity, Transform transform);
-	void GarbageCollect(const EntityManager& entityManager);
+	void AddBatch(const Entity* entities, const Transform* transforms, size_t count);
+	void RemoveDestroyed(const DestroyedEntities& destroyed) override;
 
 	size_t Count() const;
 	void Clear();
 
+	// Every entity whose transform was added or handed out through GetMutable since the last ClearChanged(),
+	// listed once each. Entities destroyed in the meantime can still show up here, so look them up before use.
+	// Bodies aren't tracked: they all move every frame, and their sprites sync straight from the archetype.
+	const std::vector<Entity>& Changed() const { return _Changed; }
+	void ClearChanged();
+
+	// Dense iteration over this store only; bodies are iterated through BodyArchetype::Query.
+	// Transforms are packed with no holes, and Entities()[i] owns the i-th transform.
+	// Order is NOT stable across RemoveDestroyed, as removal swaps the last element into the gap.
+
+	// Read only, so every write goes through GetMutable and gets tracked.
+	// ReSharper disable once CppInconsistentNaming
+	std::vector<Transform>::const_iterator begin() const { return _Transforms.begin(); }
+	// ReSharper disable once CppInconsistentNaming
+	std::vector<Transform>::const_iterator end() const { return _Transforms.end(); }
+
+	const std::vector<Entity>& Entities() const { return _Entities; }
+
 private:
-	std::unordered_map<Entity, Transform> _Transforms;
+	void Remove(Entity entity);
+	bool Lookup(Entity entity, size_t* index) const;
+	void MarkChanged(size_t index);
+
+	static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+	// Sparse set: _Sparse is indexed by Entity::Index() and points into the packed arrays below.
+	std::vector<uint32_t> _Sparse;
+
+	std::vector<Entity> _Entities;
+	std::vector<Transform> _Transforms;
+
+	// Parallel to the packed arrays, so the flag moves with its transform on removal.
+	std::vector<uint8_t> _IsChanged;
+	std::vector<Entity> _Changed;
+
+	BodyArchetype& _Bodies;
 };
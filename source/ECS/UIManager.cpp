@@ -86,12 +86,12 @@ UIManager::MakeButton(const Entity& entity, const AABB& box, const SpriteID spri
 }
 
 void
-UIManager::GarbageCollect()
+UIManager::RemoveDestroyed(const DestroyedEntities& destroyed)
 {
 	_UIButtons.erase(std::remove_if(_UIButtons.begin(), _UIButtons.end(),
 	                                [&](UIButton& button) -> bool
 	                                {
-		                                return (!_EntityManager.Exists(button.Entity));
+		                                return destroyed.Contains(button.Entity);
 	                                }), _UIButtons.end()); // <-- Don't forget this bad boy here. C++ isn't user-friendly.
 }
 
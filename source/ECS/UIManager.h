@@ -2,6 +2,7 @@
 
 #include <functional>
 
+#include "ComponentStore.h"
 #include "Entity.h"
 #include "../Math/AABB.h"
 #include "../Renderer/SpriteID.h"
@@ -10,7 +11,7 @@ struct InputBuffer;
 class RenderQueue;
 class EntityManager;
 
-class UIManager
+class UIManager final : public ComponentStore
 {
 public:
 	UIManager(EntityManager& entityManager, const InputBuffer& inputBuffer);
@@ -19,7 +20,7 @@ public:
 
 	void Render(RenderQueue& renderQueue);
 
-	void GarbageCollect();
+	void RemoveDestroyed(const DestroyedEntities& destroyed) override;
 	void Clear();
 
 private:
@@ -50,6 +50,7 @@ Create::GetCollisionRadiusFromColliderType(const AsteroidType& type)
 
 Create::Create(Game& game,
                EntityManager& entities,
+               BodyArchetype& bodies,
                TransformManager& transforms,
                SpriteManager& sprites,
                RigidbodyManager& rigidbodies,
@@ -57,6 +58,7 @@ Create::Create(Game& game,
                Timer& timer)
 	: _Game(game),
 	  _EntityManager(entities),
+	  _Bodies(bodies),
 	  _TransManager(transforms),
 	  _RigidbodyManager(rigidbodies),
 	  _SpriteManager(sprites),
@@ -77,15 +79,59 @@ Create::Asteroid(const Vector2& position,
 	Transform trans;
 	trans.pos = position;
 	trans.rot = rotation;
-	_TransManager.Add(entity, trans);
-	_RigidbodyManager.Add(entity, GetColliderFor(asteroidType), velocity, rotVelocity);
-	_SpriteManager.Create(entity, GetSpriteFor(asteroidType), RenderQueue::Layer::DEFAULT);
+	AddBody(entity, trans, GetColliderFor(asteroidType), velocity, rotVelocity, GetSpriteFor(asteroidType), RenderQueue::Layer::DEFAULT);
 
 	return entity;
 }
 
+void
+Create::AddBody(const Entity& entity,
+                const Transform& trans,
+                const ColliderType colliderType,
+                const Vector2& velocity,
+                const float rotVelocity,
+                const SpriteID spriteID,
+                const RenderQueue::Layer layer) const
+{
+	const auto rb              = MakeRigidbody(entity, colliderType, velocity, rotVelocity);
+	const auto spriteTransform = MakeBodySprite(trans, spriteID, layer);
+	const auto frameTimer      = MakeFrameTimer(spriteID);
+
+	_Bodies.Add(entity, trans, rb, spriteTransform, frameTimer);
+}
+
+Rigidbody
+Create::MakeRigidbody(const Entity& entity, const ColliderType colliderType, const Vector2& velocity, const float rotVelocity)
+{
+	Rigidbody rb;
+	rb.entity          = entity;
+	rb.colliderType    = colliderType;
+	rb.velocity        = velocity;
+	rb.angularVelocity = rotVelocity;
+	return rb;
+}
+
+SpriteFrameTimer
+Create::MakeFrameTimer(const SpriteID spriteID)
+{
+	if(!SpriteAtlas::IsAnimated(spriteID))
+		return {};
+	return { SpriteAnimationData::FRAME_TIME[static_cast<int>(spriteID)] };
+}
+
+SpriteTransform
+Create::MakeBodySprite(const Transform& trans, const SpriteID spriteID, const RenderQueue::Layer layer) const
+{
+	// Invisible bodies keep SpriteID::NONE, which the sprite passes skip.
+	auto spriteTransform = SpriteTransform();
+	if(spriteID != SpriteID::NONE)
+		spriteTransform = _SpriteManager.MakeSpriteTransform(trans, spriteID, layer);
+	spriteTransform.ID = spriteID;
+	return spriteTransform;
+}
+
 std::array<Entity, 4>
-Create::SplitAsteroid(const Entity& asteroid, const float& splitImpulse) const
+Create::SplitAsteroid(const Entity& asteroid, const float& splitImpulse)
 {
 	std::array<Entity, 4> retVal = { Entity::Null(), Entity::Null(), Entity::Null(), Entity::Null() };
 
@@ -144,20 +190,30 @@ Create::SplitAsteroid(const Entity& asteroid, const float& splitImpulse) const
 	directions.at(3) = (halfParentForward - halfParentRight);
 
 
-	for(auto i = 0; i < 4; i++)
+	auto& children = _BatchEntities;
+	children.clear();
+	_EntityManager.CreateBatch(4, children);
+
+	std::array<Transform, 4> transforms {};
+	std::array<Rigidbody, 4> rigidbodies {};
+	std::array<SpriteTransform, 4> spriteTransforms {};
+	std::array<SpriteFrameTimer, 4> frameTimers {};
+
+	for(size_t i = 0; i < children.size(); i++)
 	{
-		auto entity = _EntityManager.Create();
+		transforms.at(i).pos = parentTransform->pos + (directions.at(i) * (parentRadius + 0.0001f));
+		transforms.at(i).rot = parentTransform->rot;
 
-		Transform trans;
-		trans.pos = parentTransform->pos + (directions.at(i) * (parentRadius + 0.0001f));
-		trans.rot = parentTransform->rot;
-		_TransManager.Add(entity, trans);
-		_RigidbodyManager.Add(entity, colliderType, parentRigid.velocity + (directions.at(i) * splitImpulse), parentRigid.angularVelocity);
-		_SpriteManager.Create(entity, sprites.at(i), RenderQueue::Layer::DEFAULT);
+		rigidbodies.at(i) = MakeRigidbody(children[i], colliderType, parentRigid.velocity + (directions.at(i) * splitImpulse),
+		                                  parentRigid.angularVelocity);
+		spriteTransforms.at(i)      = MakeBodySprite(transforms.at(i), sprites.at(i), RenderQueue::Layer::DEFAULT);
+		frameTimers.at(i)           = MakeFrameTimer(sprites.at(i));
 
-		retVal.at(i) = entity;
+		retVal.at(i) = children[i];
 	}
 
+	_Bodies.AddBatch(children.size(), children.data(), transforms.data(), rigidbodies.data(), spriteTransforms.data(), frameTimers.data());
+
 	LargeExplosion(parentTransform->pos, -parentRigid.velocity, Math::RandomRange(5.0f, 50.0f));
 	_EntityManager.Destroy(asteroid);
 
@@ -241,6 +297,63 @@ Create::LargeExplosion(const Vector2& position, const Vector2& velocity, const f
 	return entity;
 }
 
+void
+Create::Explosions(const ExplosionSize size, const size_t count, const Vector2* positions, const Vector2* velocities)
+{
+	auto spriteID    = SpriteID::EXPLOSION;
+	auto minLifetime = 0.8f;
+	auto maxLifetime = 0.8f;
+	switch(size)
+	{
+		case ExplosionSize::TINY:
+		{
+			spriteID    = SpriteID::BULLET;
+			minLifetime = 0.5f;
+			maxLifetime = 1.0f;
+			break;
+		}
+		case ExplosionSize::SMALL:
+		{
+			spriteID    = SpriteID::SMALL_EXPLOSION;
+			minLifetime = 0.3f;
+			maxLifetime = 0.8f;
+			break;
+		}
+		case ExplosionSize::LARGE: break;
+	}
+
+	auto& entities = _BatchEntities;
+	entities.clear();
+	_EntityManager.CreateBatch(count, entities);
+	const auto created = entities.size();
+
+	auto& transforms       = _BatchTransforms;
+	auto& spriteTransforms = _BatchSpriteTransforms;
+	auto& rigidbodies      = _BatchRigidbodies;
+	transforms.resize(created);
+	spriteTransforms.resize(created);
+	rigidbodies.clear();
+
+	for(size_t i = 0; i < created; ++i)
+	{
+		transforms[i].pos   = positions[i];
+		transforms[i].rot   = Math::RandomRange(0.0f, 360.0f);
+		spriteTransforms[i] = _SpriteManager.MakeSpriteTransform(transforms[i], spriteID, RenderQueue::Layer::PARTICLE);
+
+		if(velocities && velocities[i] != Vector2::Zero())
+			rigidbodies.push_back(MakeRigidbody(entities[i], ColliderType::NONE, velocities[i], 0.0f));
+	}
+
+	_TransManager.AddBatch(entities.data(), transforms.data(), created);
+	_SpriteManager.CreateBatch(entities.data(), spriteTransforms.data(), created, SpriteManager::RenderFlags::REPEATING);
+	_RigidbodyManager.AddBatch(rigidbodies.data(), rigidbodies.size());
+
+	for(const auto& entity : entities)
+	{
+		_EntityManager.DestroyDelayed(entity, minLifetime < maxLifetime ? Math::RandomRange(minLifetime, maxLifetime) : minLifetime);
+	}
+}
+
 ColliderType
 Create::GetColliderFor(const AsteroidType& asteroidType)
 {
@@ -299,13 +412,13 @@ Create::GetSpriteFor(const AsteroidType& asteroidType) const
 }
 
 
-Entity
-Create::Bullet(const BulletType bulletType, const Vector2& position, const Vector2& velocity, const float& secondsToLive) const
+void
+Create::Bullets(const BulletType bulletType,
+                const size_t count,
+                const Vector2* positions,
+                const Vector2* velocities,
+                const float& secondsToLive)
 {
-	const auto entity = _EntityManager.Create();
-
-	// std::cout << "Created bullet with EID " << entity.ToString() << ".\n";
-
 	auto spriteID     = SpriteID::NONE;
 	auto colliderType = ColliderType::NONE;
 	switch(bulletType)
@@ -331,19 +444,36 @@ Create::Bullet(const BulletType bulletType, const Vector2& position, const Vecto
 		default:assert(!"Missing Bullet Type");
 	}
 
-	Transform trans;
-	trans.pos = position;
-	trans.rot = velocity.GetAngleDegFromVector() - 90.0f;
-
-	_TransManager.Add(entity, trans);
-	_RigidbodyManager.Add(entity, colliderType, velocity, 0);
+	// Build the whole volley column by column, then hand it to the body store in one go.
+	auto& entities = _BatchEntities;
+	entities.clear();
+	_EntityManager.CreateBatch(count, entities);
+	const auto created = entities.size();
+
+	auto& transforms       = _BatchTransforms;
+	auto& rigidbodies      = _BatchRigidbodies;
+	auto& spriteTransforms = _BatchSpriteTransforms;
+	auto& frameTimers      = _BatchFrameTimers;
+	transforms.resize(created);
+	rigidbodies.resize(created);
+	spriteTransforms.resize(created);
+	frameTimers.assign(created, MakeFrameTimer(spriteID));
+
+	for(size_t i = 0; i < created; ++i)
+	{
+		transforms[i].pos = positions[i];
+		transforms[i].rot = velocities[i].GetAngleDegFromVector() - 90.0f;
 
-	if(spriteID != SpriteID::NONE)
-		_SpriteManager.Create(entity, spriteID, RenderQueue::Layer::PARTICLE);
+		rigidbodies[i]      = MakeRigidbody(entities[i], colliderType, velocities[i], 0);
+		spriteTransforms[i] = MakeBodySprite(transforms[i], spriteID, RenderQueue::Layer::PARTICLE);
+	}
 
-	_EntityManager.DestroyDelayed(entity, secondsToLive);
+	_Bodies.AddBatch(created, entities.data(), transforms.data(), rigidbodies.data(), spriteTransforms.data(), frameTimers.data());
 
-	return entity;
+	for(const auto& entity : entities)
+	{
+		_EntityManager.DestroyDelayed(entity, secondsToLive);
+	}
 }
 
 Entity
@@ -2,10 +2,12 @@
 
 #include <array>
 #include <functional>
+#include <vector>
 
 #include "WeaponType.h"
 #include "../Physics/ColliderType.h"
 #include "../Renderer/SpriteAtlas.h"
+#include "../ECS/BodyArchetype.h"
 #include "../ECS/SpriteManager.h"
 
 #include "../Math/Vector2.h"
@@ -14,7 +16,6 @@ struct Transform;
 class ShipInfo;
 class Game;
 
-class Entity;
 class EntityManager;
 class TransformManager;
 class RigidbodyManager;
@@ -55,15 +56,16 @@ public:
 
 	static float GetCollisionRadiusFromColliderType(const AsteroidType& type);
 
-	Create(Game& game, EntityManager& entities, TransformManager& transforms, SpriteManager& sprites,
+	Create(Game& game, EntityManager& entities, BodyArchetype& bodies, TransformManager& transforms, SpriteManager& sprites,
 		RigidbodyManager& rigidbodies, UIManager& uiManager, Timer& timer);
 
 	Entity Asteroid(const Vector2& position, const float& rotation,
 		const Vector2& velocity, const float& rotVelocity, const AsteroidType& asteroidType) const;
-	std::array<Entity, 4> SplitAsteroid(const Entity& asteroid, const float& splitImpulse) const;
+	std::array<Entity, 4> SplitAsteroid(const Entity& asteroid, const float& splitImpulse);
 
 	Entity MuzzleFlash(const Vector2& position, const Vector2& velocity) const;
-	Entity Bullet(BulletType bulletType, const Vector2& position, const Vector2& velocity, const float& secondsToLive) const;
+	// Fires `count` bullets at once: bullet i spawns at positions[i] travelling at velocities[i].
+	void Bullets(BulletType bulletType, size_t count, const Vector2* positions, const Vector2* velocities, const float& secondsToLive);
 
 	Entity Ship(const ShipInfo& shipInfo, const Vector2& position, const float& rotation, const Vector2& initialVelocity = Vector2::Zero(), const float& initialAngularVelocity = 0) const;
 	Entity ShipThruster(const Entity& ship, const Vector2& thrusterOffset, const float& thrusterRotation, SpriteID spriteID) const;
@@ -72,6 +74,16 @@ public:
 	[[maybe_unused]] Entity SmallExplosion(const Vector2& position, const Vector2& velocity = Vector2::Zero(), const float& rotVelocity = 0) const;
 	[[maybe_unused]] Entity LargeExplosion(const Vector2& position, const Vector2& velocity = Vector2::Zero(), const float& rotVelocity = 0) const;
 
+	enum class ExplosionSize
+	{
+		TINY,
+		SMALL,
+		LARGE,
+	};
+
+	// Spawns `count` explosions in one go. Velocities may be null, in which case the explosions stay put.
+	void Explosions(ExplosionSize size, size_t count, const Vector2* positions, const Vector2* velocities = nullptr);
+
 	Entity UIButton(const AABB& position, SpriteID spriteID, std::function<void()> callback) const;
 
 	Entity StaticSprite(const Transform& trans, SpriteID spriteID, RenderQueue::Layer layer, SpriteManager::RenderFlags renderFlags, float scale = 1.0f) const;
@@ -83,11 +95,28 @@ private:
 	static ColliderType GetColliderFor(const AsteroidType& asteroidType);
 	SpriteID GetSpriteFor(const AsteroidType& asteroidType) const;
 
+	// Asteroids and bullets go straight into the body archetype rather than through the individual managers.
+	void AddBody(const Entity& entity, const Transform& trans, ColliderType colliderType, const Vector2& velocity,
+		float rotVelocity, SpriteID spriteID, RenderQueue::Layer layer) const;
+	static Rigidbody MakeRigidbody(const Entity& entity, ColliderType colliderType, const Vector2& velocity, float rotVelocity);
+	// FRAME_TIME only covers the animated sprites, so everything else starts with a timer that never runs.
+	static SpriteFrameTimer MakeFrameTimer(SpriteID spriteID);
+	SpriteTransform MakeBodySprite(const Transform& trans, SpriteID spriteID, RenderQueue::Layer layer) const;
+
 	Game& _Game;
 	EntityManager& _EntityManager;
+	BodyArchetype& _Bodies;
 	TransformManager& _TransManager;
 	RigidbodyManager& _RigidbodyManager;
 	SpriteManager& _SpriteManager;
 	UIManager& _UIManager;
 	Timer& _Timer;
+
+	// Scratch space for laying out a batch before it is handed to the stores. Cleared and reused by every batch, so
+	// spawning stops allocating once these have grown to the biggest volley.
+	std::vector<Entity> _BatchEntities;
+	std::vector<Transform> _BatchTransforms;
+	std::vector<Rigidbody> _BatchRigidbodies;
+	std::vector<SpriteTransform> _BatchSpriteTransforms;
+	std::vector<SpriteFrameTimer> _BatchFrameTimers;
 };
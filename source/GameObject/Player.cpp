@@ -1,6 +1,7 @@
 #include "Player.h"
 
 #include <algorithm> // min
+#include <array>
 
 #include "../ECS/EntityManager.h"
 #include "../ECS/RigidbodyManager.h"
@@ -56,30 +57,36 @@ Player::Kill(const Entity& playerEntity, const Vector2& playerVelocity)
 	_Game.Entities.Destroy(_Entity);
 
 
-	// ReSharper disable CppExpressionWithoutSideEffects
+	std::array<Vector2, 12> positions {};
+	std::array<Vector2, 12> velocities {};
+
 	for(auto i = 0; i < 3; ++i)
 	{
 		auto spawnDistanceFromPlayer = Math::RandomRange(10.0f, 17.0f);
 
 		const auto offset = Vector2::Forward().RotateRad(Math::RandomRange(0.0f, Math::TAU)) * spawnDistanceFromPlayer;
-		_Game.Create.LargeExplosion(shipPos + offset);
-		_Game.Create.LargeExplosion(shipPos + offset);
-		_Game.Create.LargeExplosion(shipPos + offset);
-		_Game.Create.LargeExplosion(shipPos + offset);
+		for(auto j = 0; j < 4; ++j)
+		{
+			positions.at(i * 4 + j) = shipPos + offset;
+		}
 	}
+	_Game.Create.Explosions(Create::ExplosionSize::LARGE, positions.size(), positions.data());
 
-	for(auto i = 0; i < 12; ++i)
+	positions.fill(shipPos);
+
+	for(auto& velocity : velocities)
 	{
 		const auto randomVelocity = Vector2::Forward().RotateRad(Math::RandomRange(0.0f, Math::TAU)) * Math::RandomRange(10.0f, 140.0f);
-		_Game.Create.SmallExplosion(shipPos, (playerVelocity * 0.1f) + randomVelocity);
+		velocity = (playerVelocity * 0.1f) + randomVelocity;
 	}
+	_Game.Create.Explosions(Create::ExplosionSize::SMALL, positions.size(), positions.data(), velocities.data());
 
-	for(auto i = 0; i < 12; ++i)
+	for(auto& velocity : velocities)
 	{
 		const auto randomVelocity = Vector2::Forward().RotateRad(Math::RandomRange(0.0f, Math::TAU)) * Math::RandomRange(60.0f, 240.0f);
-		_Game.Create.TinyExplosion(shipPos, (playerVelocity * 0.1f) + randomVelocity);
+		velocity = (playerVelocity * 0.1f) + randomVelocity;
 	}
-	// ReSharper restore CppExpressionWithoutSideEffects
+	_Game.Create.Explosions(Create::ExplosionSize::TINY, positions.size(), positions.data(), velocities.data());
 
 	_Entity = Entity::Null();
 	_Health = _Ship.StartingHealth;
@@ -193,13 +200,18 @@ Player::Update(const InputBuffer& inputBuffer, const float& deltaTime)
 		auto bulletForward = forward.RotateDeg(-_Weapon.BulletSpawnArcDeg * 0.5f);
 
 		const auto spawnArcIncrement = _Weapon.BulletSpawnArcDeg / (_Weapon.BulletSpawnCount - 1);
+
+		// Lay the volley out first so it can be spawned as a single batch.
+		_BulletPositions.clear();
+		_BulletVelocities.clear();
 		for(auto i = 0; i < _Weapon.BulletSpawnCount; ++i)
 		{
-			// ReSharper disable once CppExpressionWithoutSideEffects
-			_Game.Create.Bullet(_Weapon.BulletType, transform.pos + (bulletForward * _Weapon.BulletSpawnOffsetY),
-			               rigid->velocity + (bulletForward * _Weapon.BulletSpeed), _Weapon.BulletLifetime);
+			_BulletPositions.push_back(transform.pos + (bulletForward * _Weapon.BulletSpawnOffsetY));
+			_BulletVelocities.push_back(rigid->velocity + (bulletForward * _Weapon.BulletSpeed));
 			bulletForward = bulletForward.RotateDeg(spawnArcIncrement);
 		}
+		_Game.Create.Bullets(_Weapon.BulletType, _BulletPositions.size(), _BulletPositions.data(), _BulletVelocities.data(),
+		                     _Weapon.BulletLifetime);
 	}
 #pragma endregion
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "ShipInfo.h"
 #include "WeaponType.h"
 
@@ -60,4 +62,8 @@ private:
 	ShipInfo _Ship;
 	WeaponType _Weapon;
 
+	// Scratch space for laying out a volley before it is spawned as one batch. Kept around so shooting doesn't allocate.
+	std::vector<Vector2> _BulletPositions;
+	std::vector<Vector2> _BulletVelocities;
+
 };
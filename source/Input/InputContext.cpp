@@ -23,6 +23,10 @@ InputContext::InputContext(bool fillWithDefaults)
 		AddOneShot(SDL_EXT_MOUSE1_DOWN, InputOneShot::MouseDown);
 		AddOneShot(SDL_EXT_MOUSE1_UP, InputOneShot::MouseUp);
 
+		AddOneShot(SDLK_F4, InputOneShot::DEBUG_ArchetypeBenchmark);
+		AddOneShot(SDLK_F5, InputOneShot::DEBUG_PhysicsBenchmark);
+		AddOneShot(SDLK_F6, InputOneShot::DEBUG_NarrowphaseBenchmark);
+		AddOneShot(SDLK_F7, InputOneShot::DEBUG_StressTest);
 		AddOneShot(SDLK_F8, InputOneShot::DEBUG_Camera);
 		AddOneShot(SDLK_F9, InputOneShot::DEBUG_SpeedDown);
 		AddOneShot(SDLK_F10, InputOneShot::DEBUG_SpeedUp);
@@ -12,6 +12,10 @@ enum class InputOneShot
     DEBUG_Camera,
 	DEBUG_SpeedDown,
 	DEBUG_SpeedUp,
+	DEBUG_StressTest,
+	DEBUG_ArchetypeBenchmark,
+	DEBUG_NarrowphaseBenchmark,
+	DEBUG_PhysicsBenchmark,
 };
 
 enum class InputToggle
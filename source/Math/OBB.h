@@ -25,6 +25,10 @@ public:
 
 	std::array<Vector2,4> GetCorners() const;
 
+	const Vector2& GetBasisX() const { return basisX; }
+	const Vector2& GetBasisY() const { return basisY; }
+	const Vector2& GetExtents() const { return extents; }
+
 	// DATA
 	Vector2 center;
 
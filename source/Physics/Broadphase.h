@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "../Math/AABB.h"
+
+#include "../Platform/FunctionRef.h"
+
+#include "ColliderType.h"
+#include "CollisionListEntry.h"
+#include "MoveList.h"
+
+// Which broadphase Physics builds. Picked once at startup.
+enum class BroadphaseType
+{
+	GRID,
+	SWEEP_AND_PRUNE,
+};
+
+// What a broadphase did in its last DetectCollisions.
+struct BroadphaseStats
+{
+	static constexpr size_t OCCUPANCY_BUCKETS = 12;
+
+	// Pairs handed to the narrowphase, hit or not.
+	uint64_t PairsTested = 0;
+
+	// How many cells held how many bodies, wrapped copies included. Bucket 0 counts the empty cells and bucket i the
+	// ones holding from 2^(i-1) up to 2^i - 1, with the last taking everything bigger. Left empty by a broadphase
+	// without cells.
+	std::array<uint32_t, OCCUPANCY_BUCKETS> CellOccupancy = {};
+
+	static size_t OccupancyBucket(size_t bodies)
+	{
+		size_t bucket = 0;
+		for(; bodies > 0 && bucket + 1 < OCCUPANCY_BUCKETS; bodies >>= 1)
+			++bucket;
+		return bucket;
+	}
+};
+
+// Works out which of the bodies filed this frame are close enough to be worth a narrowphase test. Bodies are filed
+// between EndFrame() calls, and the field wraps, so a body near one edge has to be able to hit one near the other.
+class Broadphase
+{
+public:
+	// Called with each body a query finds. Only borrowed for the call, so it's free to capture anything.
+	using Visitor = FunctionRef<void(const MoveList::Entry&)>;
+
+	virtual ~Broadphase() = default;
+
+	// Files a body for this frame. `bounds` is its AABB padded by this frame's movement, and may hang off the field.
+	virtual void Insert(const MoveList::Entry& entry, const AABB& bounds) = 0;
+
+	// Runs the narrowphase over everything filed this frame. Each pool worker appends to its own list in `collisions`,
+	// indexed by ThreadPool::CurrentWorker(). Every pair is reported once, however many wrapped copies of it there are.
+	virtual void DetectCollisions(float deltaTime, std::vector<std::vector<CollisionListEntry>>& collisions) = 0;
+
+	// Calls `visit` with every body filed this frame whose bounds might overlap `bounds`, which may hang off the field.
+	// Only valid once DetectCollisions has run. A body can be visited more than once, and at a wrapped position.
+	virtual void ForEachNear(const AABB& bounds, Visitor visit) const = 0;
+
+	// As ForEachNear, for the bodies whose bounds the segment from `start` to `end` might cross. Physics pads bounds
+	// well past a bullet's radius, so a bullet's motion for the frame is all it has to cast.
+	virtual void ForEachAlongSegment(const Vector2& start,
+	                                 const Vector2& end,
+	                                 Visitor visit) const = 0;
+
+	// Only meaningful once DetectCollisions has run.
+	virtual const BroadphaseStats& GetStats() const = 0;
+
+	// Forgets this frame's bodies.
+	virtual void EndFrame() = 0;
+};
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstdint>
+
 #include "../Math/AABB.h"
 
-enum class ColliderType
+// One byte, so it packs in beside an entity handle in MoveList::Entry.
+enum class ColliderType : uint8_t
 {
 	NONE,
 
@@ -46,6 +49,12 @@ IsPlayerShip(const ColliderType& type)
 	return (type >= ColliderType::SHIP_1 && type < ColliderType::SHIP_END);
 }
 
+inline bool
+IsBullet(const ColliderType& type)
+{
+	return (type == ColliderType::BULLET || type == ColliderType::BOUNCY_BULLET);
+}
+
 
 inline float
 GetRadiusFromType(const ColliderType& type)
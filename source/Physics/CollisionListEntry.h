@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cfloat>
+#include <cmath>
+
+#include "../ECS/Entity.h"
+
+#include "ColliderType.h"
+
+struct CollisionListEntry
+{
+	Entity A;
+	Entity B;
+	ColliderType EntityAType;
+	ColliderType EntityBType;
+	float MassA;
+	float MassB;
+	float TimeOfCollision;
+
+	bool operator<(const CollisionListEntry& other) const
+	{
+		return (this->TimeOfCollision < other.TimeOfCollision);
+	}
+
+	bool operator==(const CollisionListEntry& other) const
+	{
+		return A == other.A &&
+			B == other.B &&
+			fabs(TimeOfCollision - other.TimeOfCollision) < FLT_EPSILON;
+	}
+};
+
+namespace std
+{
+template <> struct hash<CollisionListEntry>
+{
+	inline size_t operator()(const CollisionListEntry& entry) const noexcept
+	{
+		return entry.A.Hash() ^ entry.B.Hash();
+	}
+};
+}
@@ -1,5 +1,20 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+// Pick the widest SIMD the compiler is targeting for the batched narrowphase. Define EUANITY_NO_SIMD to force the
+// scalar path everywhere.
+#if !defined(EUANITY_NO_SIMD) && defined(__AVX2__)
+#define EUANITY_SIMD_AVX2
+#include <immintrin.h>
+#elif !defined(EUANITY_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define EUANITY_SIMD_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../Math/EuanityMath.h"
 #include "../Math/Vector2.h"
 #include "../Math/Circle.h"
@@ -42,7 +57,9 @@ SweptCircleToCircle(const Vector2& centerA,
 		return false;
 	}
 
-	const float scalarTerm = 2 * Dot(relativeVelocity, startPositionDelta); // t
+	// |d + v*t|^2 = r^2 expands to (v.v)t^2 + 2(v.d)t + (d.d - r^2) = 0. This is half the linear coefficient, which
+	// is what the determinant and root below are written for, so it must not be doubled.
+	const float scalarTerm = Dot(relativeVelocity, startPositionDelta); // t
 	if(scalarTerm >= 0.0f)
 	{
 		// Circles are moving away from each other, all roots will be negative.
@@ -65,6 +82,150 @@ SweptCircleToCircle(const Vector2& centerA,
 		return false;
 }
 
+// SweptCircleToCircle for one circle against `count` others, whose centers and velocities are given as separate
+// x and y lanes. Calls onHit(index, timeUntilCollision) for every one we will collide with this frame. Plain loop,
+// kept as the fallback and for checking the SIMD version against.
+template <typename OnHit>
+void
+SweptCircleToCirclesScalar(const Vector2& centerA,
+                           const Vector2& velA,
+                           const float* centerX,
+                           const float* centerY,
+                           const float* velX,
+                           const float* velY,
+                           const size_t count,
+                           const float& combinedRadiiSq,
+                           const float& deltaTime,
+                           OnHit&& onHit)
+{
+	for(size_t i = 0; i < count; ++i)
+	{
+		float timeUntilCollision;
+		if(SweptCircleToCircle(centerA, velA, Vector2(centerX[i], centerY[i]), Vector2(velX[i], velY[i]),
+		                       0.0f, combinedRadiiSq, deltaTime, timeUntilCollision))
+		{
+			onHit(i, timeUntilCollision);
+		}
+	}
+}
+
+// Same tests and results as SweptCircleToCirclesScalar, 8 (AVX2) or 4 (SSE) candidates at a time. The intersecting,
+// stationary and separating cases are folded into one mask, and a group where every lane is out skips the square
+// root and divide entirely. Leftovers that don't fill a vector go through the scalar loop.
+template <typename OnHit>
+void
+SweptCircleToCircles(const Vector2& centerA,
+                     const Vector2& velA,
+                     const float* centerX,
+                     const float* centerY,
+                     const float* velX,
+                     const float* velY,
+                     const size_t count,
+                     const float& combinedRadiiSq,
+                     const float& deltaTime,
+                     OnHit&& onHit)
+{
+	size_t i = 0;
+
+#if defined(EUANITY_SIMD_AVX2)
+	constexpr size_t WIDTH = 8;
+	const auto ax       = _mm256_set1_ps(centerA.x);
+	const auto ay       = _mm256_set1_ps(centerA.y);
+	const auto avx      = _mm256_set1_ps(velA.x);
+	const auto avy      = _mm256_set1_ps(velA.y);
+	const auto radiiSq  = _mm256_set1_ps(combinedRadiiSq);
+	const auto dt       = _mm256_set1_ps(deltaTime);
+	const auto zero     = _mm256_setzero_ps();
+	const auto one      = _mm256_set1_ps(1.0f);
+	const auto minSpeed = _mm256_set1_ps(0.00001f);
+
+	for(; i + WIDTH <= count; i += WIDTH)
+	{
+		const auto dx       = _mm256_sub_ps(_mm256_loadu_ps(centerX + i), ax);
+		const auto dy       = _mm256_sub_ps(_mm256_loadu_ps(centerY + i), ay);
+		const auto constant = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), radiiSq);
+
+		const auto rvx     = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(velX + i), avx), dt);
+		const auto rvy     = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(velY + i), avy), dt);
+		const auto squared = _mm256_add_ps(_mm256_mul_ps(rvx, rvx), _mm256_mul_ps(rvy, rvy));
+		const auto scalar  = _mm256_add_ps(_mm256_mul_ps(rvx, dx), _mm256_mul_ps(rvy, dy));
+		const auto det     = _mm256_sub_ps(_mm256_mul_ps(scalar, scalar), _mm256_mul_ps(squared, constant));
+
+		// Not intersecting, not relatively stationary, closing, and with real roots.
+		const auto candidates = _mm256_and_ps(
+			_mm256_and_ps(_mm256_cmp_ps(constant, zero, _CMP_GE_OQ), _mm256_cmp_ps(squared, minSpeed, _CMP_GE_OQ)),
+			_mm256_and_ps(_mm256_cmp_ps(scalar, zero, _CMP_LT_OQ), _mm256_cmp_ps(det, zero, _CMP_GE_OQ)));
+		auto bits = _mm256_movemask_ps(candidates);
+		if(bits == 0)
+			continue;
+
+		const auto time = _mm256_div_ps(_mm256_sub_ps(_mm256_sub_ps(zero, scalar), _mm256_sqrt_ps(_mm256_max_ps(det, zero))), squared);
+		bits &= _mm256_movemask_ps(_mm256_cmp_ps(time, one, _CMP_LT_OQ));
+		if(bits == 0)
+			continue;
+
+		alignas(32) float times[WIDTH];
+		_mm256_store_ps(times, time);
+		for(size_t lane = 0; lane < WIDTH; ++lane)
+		{
+			if(bits & (1 << lane))
+				onHit(i + lane, times[lane]);
+		}
+	}
+#elif defined(EUANITY_SIMD_SSE)
+	constexpr size_t WIDTH = 4;
+	const auto ax       = _mm_set1_ps(centerA.x);
+	const auto ay       = _mm_set1_ps(centerA.y);
+	const auto avx      = _mm_set1_ps(velA.x);
+	const auto avy      = _mm_set1_ps(velA.y);
+	const auto radiiSq  = _mm_set1_ps(combinedRadiiSq);
+	const auto dt       = _mm_set1_ps(deltaTime);
+	const auto zero     = _mm_setzero_ps();
+	const auto one      = _mm_set1_ps(1.0f);
+	const auto minSpeed = _mm_set1_ps(0.00001f);
+
+	for(; i + WIDTH <= count; i += WIDTH)
+	{
+		const auto dx       = _mm_sub_ps(_mm_loadu_ps(centerX + i), ax);
+		const auto dy       = _mm_sub_ps(_mm_loadu_ps(centerY + i), ay);
+		const auto constant = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), radiiSq);
+
+		const auto rvx     = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(velX + i), avx), dt);
+		const auto rvy     = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(velY + i), avy), dt);
+		const auto squared = _mm_add_ps(_mm_mul_ps(rvx, rvx), _mm_mul_ps(rvy, rvy));
+		const auto scalar  = _mm_add_ps(_mm_mul_ps(rvx, dx), _mm_mul_ps(rvy, dy));
+		const auto det     = _mm_sub_ps(_mm_mul_ps(scalar, scalar), _mm_mul_ps(squared, constant));
+
+		// Not intersecting, not relatively stationary, closing, and with real roots.
+		const auto candidates = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(constant, zero), _mm_cmpge_ps(squared, minSpeed)),
+		                                   _mm_and_ps(_mm_cmplt_ps(scalar, zero), _mm_cmpge_ps(det, zero)));
+		auto bits = _mm_movemask_ps(candidates);
+		if(bits == 0)
+			continue;
+
+		const auto time = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(zero, scalar), _mm_sqrt_ps(_mm_max_ps(det, zero))), squared);
+		bits &= _mm_movemask_ps(_mm_cmplt_ps(time, one));
+		if(bits == 0)
+			continue;
+
+		alignas(16) float times[WIDTH];
+		_mm_store_ps(times, time);
+		for(size_t lane = 0; lane < WIDTH; ++lane)
+		{
+			if(bits & (1 << lane))
+				onHit(i + lane, times[lane]);
+		}
+	}
+#endif
+
+	SweptCircleToCirclesScalar(centerA, velA, centerX + i, centerY + i, velX + i, velY + i, count - i,
+	                           combinedRadiiSq, deltaTime,
+	                           [&](const size_t index, const float timeUntilCollision)
+	                           {
+		                           onHit(i + index, timeUntilCollision);
+	                           });
+}
+
 inline bool
 AABBToAABB(const AABB& a, const AABB& b)
 {
@@ -81,11 +242,120 @@ CircleToCircle(const Circle& a, const Circle& b)
 }
 
 
-// This test is *very simple* because our specific usecase does not call for
-// a swept test, and I don't want to have to implement full GJK/minkowski stuff.
+// Where along the segment from `start` by `motion` a point first enters the circle, as a fraction of `motion`.
+// Starting inside is a hit at zero.
+inline bool
+SegmentToCircle(const Vector2& start, const Vector2& motion, const Circle& circle, float& timeUntilCollision)
+{
+	const auto fromCenter   = start - circle.Center;
+	const auto constantTerm = Dot(fromCenter, fromCenter) - circle.Radius * circle.Radius;
+	if(constantTerm <= 0.0f)
+	{
+		timeUntilCollision = 0.0f;
+		return true;
+	}
+
+	const auto squaredTerm = Dot(motion, motion);
+	const auto scalarTerm  = Dot(motion, fromCenter);
+	if(squaredTerm < 0.00001f || scalarTerm >= 0.0f)
+		return false;
+
+	const auto determinant = scalarTerm * scalarTerm - squaredTerm * constantTerm;
+	if(determinant < 0.0f)
+		return false;
+
+	const auto time = (-scalarTerm - sqrt(determinant)) / squaredTerm;
+	if(time > 1.0f)
+		return false;
+
+	timeUntilCollision = time;
+	return true;
+}
+
+// This test is *very simple*, and only says whether they overlap right now. SweptOBBToCircle is the one that can't
+// be tunnelled through.
 inline bool
 OBBToCircle(const OBB& OBB, const Circle& circle)
 {
 	return OBB.DistanceBetweenSq(circle.Center) < circle.Radius * circle.Radius;
 }
+
+// Continuous OBBToCircle. In the box's space, the circle's centre is cast along the relative motion against the box
+// grown by the radius, with its corners rounded off. The box keeps its current rotation for the frame, which is close
+// enough for how fast ships turn.
+// Fills timeUntilCollision as SweptCircleToCircle does, but starting out overlapping is a hit at zero, as the
+// discrete test treated it.
+inline bool
+SweptOBBToCircle(const OBB& box,
+                 const Vector2& boxVel,
+                 const Circle& circle,
+                 const Vector2& circleVel,
+                 const float& deltaTime,
+                 float& timeUntilCollision)
+{
+	if(OBBToCircle(box, circle))
+	{
+		timeUntilCollision = 0.0f;
+		return true;
+	}
+
+	const auto offset  = circle.Center - box.center;
+	const auto motion  = (circleVel - boxVel) * deltaTime;
+	const auto extents = box.GetExtents();
+
+	const float start[2] = { Dot(offset, box.GetBasisX()), Dot(offset, box.GetBasisY()) };
+	const float delta[2] = { Dot(motion, box.GetBasisX()), Dot(motion, box.GetBasisY()) };
+	const float inner[2] = { extents.x, extents.y };
+	const float grown[2] = { extents.x + circle.Radius, extents.y + circle.Radius };
+
+	// Slab test against the grown box, clipped to this frame.
+	auto enter = 0.0f;
+	auto leave = 1.0f;
+	for(auto axis = 0; axis < 2; ++axis)
+	{
+		if(fabs(delta[axis]) < 0.00001f)
+		{
+			// Not moving on this axis, so it's either inside the slab all frame or never.
+			if(fabs(start[axis]) > grown[axis])
+				return false;
+			continue;
+		}
+
+		const auto inverse = 1.0f / delta[axis];
+		auto from          = (-grown[axis] - start[axis]) * inverse;
+		auto to            = (grown[axis] - start[axis]) * inverse;
+		if(from > to)
+			std::swap(from, to);
+
+		enter = std::max(enter, from);
+		leave = std::min(leave, to);
+		if(enter > leave)
+			return false;
+	}
+
+	// Coming in through a face of the grown box is a hit. Coming in by a corner, it's the rounding that counts.
+	const float hit[2] = { start[0] + delta[0] * enter, start[1] + delta[1] * enter };
+	if(fabs(hit[0]) <= inner[0] || fabs(hit[1]) <= inner[1])
+	{
+		timeUntilCollision = enter;
+		return true;
+	}
+
+	const Vector2 fromCorner(start[0] - copysign(inner[0], hit[0]), start[1] - copysign(inner[1], hit[1]));
+	const Vector2 direction(delta[0], delta[1]);
+
+	const auto squaredTerm  = Dot(direction, direction);
+	const auto scalarTerm   = Dot(direction, fromCorner);
+	const auto constantTerm = Dot(fromCorner, fromCorner) - circle.Radius * circle.Radius;
+	const auto determinant  = scalarTerm * scalarTerm - squaredTerm * constantTerm;
+	if(determinant < 0.0f || squaredTerm < 0.00001f)
+		return false;
+
+	const auto time = (-scalarTerm - sqrt(determinant)) / squaredTerm;
+	if(time < 0.0f || time > 1.0f)
+		return false;
+
+	timeUntilCollision = time;
+	return true;
+}
 }
@@ -0,0 +1,158 @@
+#include <algorithm>
+
+#include "ContactCache.h"
+
+ContactCache::ContactCache(const size_t workerCount)
+	: _WorkerTallies(workerCount)
+{
+}
+
+void
+ContactCache::BeginFrame()
+{
+	for(auto& tally : _WorkerTallies)
+	{
+		tally.Hits   = 0;
+		tally.Misses = 0;
+		tally.Records.clear();
+	}
+
+	_Counters = ContactCacheCounters();
+}
+
+void
+ContactCache::SetReach(const Entity& entity, const float distance)
+{
+	// An index picks up the total of whoever had it before, which is fine, as only the growth matters.
+	if(entity.Index() >= _Travelled.size())
+	{
+		_Travelled.resize(static_cast<size_t>(entity.Index()) + 1, 0.0f);
+		_Reach.resize(_Travelled.size(), 0.0f);
+	}
+
+	_Reach[entity.Index()] = _Travelled[entity.Index()] + distance;
+}
+
+bool
+ContactCache::CanSkip(const Entity& a, const Entity& b, const size_t worker)
+{
+	Entity lower, upper;
+	Order(a, b, lower, upper);
+
+	auto& tally = _WorkerTallies[worker];
+	if(lower.Index() < _Buckets.size())
+	{
+		const auto& bucket = _Buckets[lower.Index()];
+		if(bucket.Owner == lower)
+		{
+			for(uint32_t i = 0; i < bucket.Count; ++i)
+			{
+				if(bucket.Slots[i].Partner != upper)
+					continue;
+
+				if(bucket.Slots[i].ExpiresAt > _Reach[lower.Index()] + _Reach[upper.Index()])
+				{
+					++tally.Hits;
+					return true;
+				}
+				break;
+			}
+		}
+	}
+
+	++tally.Misses;
+	return false;
+}
+
+void
+ContactCache::Record(const Entity& a, const Entity& b, const float separation, const size_t worker)
+{
+	const auto travelled = _Travelled[a.Index()] + _Travelled[b.Index()];
+	const auto closing   = _Reach[a.Index()] + _Reach[b.Index()] - travelled;
+
+	const auto safeSeparation = separation - SEPARATION_MARGIN - travelled * RELATIVE_SEPARATION_MARGIN;
+	if(safeSeparation <= closing * CACHE_MIN_FRAMES)
+		return;
+
+	PendingRecord record;
+	Order(a, b, record.Lower, record.Upper);
+	record.ExpiresAt = travelled + safeSeparation;
+	_WorkerTallies[worker].Records.push_back(record);
+}
+
+void
+ContactCache::Commit()
+{
+	for(const auto& tally : _WorkerTallies)
+	{
+		_Counters.Hits += tally.Hits;
+		_Counters.Misses += tally.Misses;
+
+		for(const auto& record : tally.Records)
+			File(record);
+	}
+}
+
+void
+ContactCache::File(const PendingRecord& record)
+{
+	if(record.Lower.Index() >= _Buckets.size())
+		_Buckets.resize(static_cast<size_t>(record.Lower.Index()) + 1);
+
+	// Whoever had this index before is gone, and so are its pairs.
+	auto& bucket = _Buckets[record.Lower.Index()];
+	if(bucket.Owner != record.Lower)
+	{
+		_Counters.Evictions += bucket.Count;
+		bucket.Owner = record.Lower;
+		bucket.Count = 0;
+	}
+
+	// Refresh the pair if it's here, or take the slot that runs out soonest.
+	uint32_t target = 0;
+	for(uint32_t i = 0; i < bucket.Count; ++i)
+	{
+		if(bucket.Slots[i].Partner == record.Upper)
+		{
+			bucket.Slots[i].ExpiresAt = record.ExpiresAt;
+			return;
+		}
+		if(bucket.Slots[i].ExpiresAt < bucket.Slots[target].ExpiresAt)
+			target = i;
+	}
+
+	if(bucket.Count < WAYS)
+	{
+		target = bucket.Count++;
+	}
+	else
+	{
+		if(bucket.Slots[target].ExpiresAt >= record.ExpiresAt)
+			return;
+
+		// One that's run out already isn't worth counting.
+		const auto partner = bucket.Slots[target].Partner.Index();
+		if(partner < _Travelled.size() &&
+			bucket.Slots[target].ExpiresAt > _Travelled[record.Lower.Index()] + _Travelled[partner])
+		{
+			++_Counters.Evictions;
+		}
+	}
+
+	bucket.Slots[target] = { record.Upper, record.ExpiresAt };
+}
+
+void
+ContactCache::Moved(const Entity& entity, const float distance)
+{
+	if(entity.Index() < _Travelled.size())
+		_Travelled[entity.Index()] += distance;
+}
+
+void
+ContactCache::Order(const Entity& a, const Entity& b, Entity& lower, Entity& upper)
+{
+	const auto isALower = a.Index() < b.Index();
+	lower               = isALower ? a : b;
+	upper               = isALower ? b : a;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../ECS/Entity.h"
+
+#include "ColliderType.h"
+
+// What the contact cache did in the last Simulate.
+struct ContactCacheCounters
+{
+	// Pairs skipped because they were still too far apart to meet.
+	uint32_t Hits = 0;
+
+	// Pairs that could be cached but had to be tested.
+	uint32_t Misses = 0;
+
+	// Cached pairs thrown out to make room, or left behind by a destroyed body.
+	uint32_t Evictions = 0;
+};
+
+// Remembers pairs of asteroids that were tested and found far enough apart that they can't meet for a few frames,
+// so the broadphase can skip them until then.
+//
+// Every body keeps a running total of how far it has moved. Two bodies can't have closed by more than their totals
+// have grown between them, so a pair is stored as how far apart they were plus both totals at the time, and stays
+// good until the totals catch up. That holds however speeds change, as the totals grow by how far bodies actually
+// moved.
+//
+// Lookups and records are safe from any pool worker between BeginFrame and Commit. Records are held per worker until
+// Commit files them.
+class ContactCache
+{
+public:
+	explicit ContactCache(size_t workerCount);
+
+	// Only asteroids move predictably enough to be worth it.
+	static bool IsCacheable(const ColliderType type)
+	{
+		return type >= ColliderType::LARGE_ASTEROID && type <= ColliderType::SMOL_ASTEROID;
+	}
+
+	static bool IsCacheable(const ColliderType a, const ColliderType b)
+	{
+		return IsCacheable(a) && IsCacheable(b);
+	}
+
+	void BeginFrame();
+
+	// How far a body can move this frame, at the speed it starts it with. Set for every cacheable body before
+	// looking any of them up.
+	void SetReach(const Entity& entity, float distance);
+
+	// Whether the pair can't meet this frame, so needn't be tested. Counts a hit or a miss against `worker`.
+	bool CanSkip(const Entity& a, const Entity& b, size_t worker);
+
+	// A pair that was tested, didn't hit, and is `separation` apart between their edges. Only kept if that will
+	// hold for the next CACHE_MIN_FRAMES frames at their current speeds.
+	void Record(const Entity& a, const Entity& b, float separation, size_t worker);
+
+	// Files the frame's records and totals the counters.
+	void Commit();
+
+	// Adds to how far a body has moved. Anything that moves a cacheable body has to report it here.
+	void Moved(const Entity& entity, float distance);
+
+	const ContactCacheCounters& GetCounters() const { return _Counters; }
+
+private:
+	struct Slot
+	{
+		Entity Partner;
+
+		// The separation plus both bodies' totals when it was measured. Once their totals add up to this, they might be
+		// touching.
+		float ExpiresAt;
+	};
+
+	// The pairs an entity is the lower index of. One cache line with 16-bit handles, so a lookup is a single miss at
+	// worst.
+	static constexpr size_t WAYS = 7;
+	struct alignas(64) Bucket
+	{
+		Entity Owner   = Entity::Null();
+		uint32_t Count = 0;
+		Slot Slots[WAYS];
+	};
+
+	struct PendingRecord
+	{
+		Entity Lower;
+		Entity Upper;
+		float ExpiresAt;
+	};
+
+	// Kept apart so workers counting don't fight over a cache line.
+	struct alignas(64) WorkerTally
+	{
+		uint32_t Hits   = 0;
+		uint32_t Misses = 0;
+		std::vector<PendingRecord> Records;
+	};
+
+	void File(const PendingRecord& record);
+
+	// Lower entity index first.
+	static void Order(const Entity& a, const Entity& b, Entity& lower, Entity& upper);
+
+	// A pair has to hold for this many frames to be worth recording.
+	static constexpr float CACHE_MIN_FRAMES = 2.0f;
+
+	// Taken off every separation, so float error in it or the totals can't let a touching pair through. The relative
+	// part covers the totals losing precision as they grow.
+	static constexpr float SEPARATION_MARGIN          = 0.01f;
+	static constexpr float RELATIVE_SEPARATION_MARGIN = 1e-6f;
+
+	std::vector<Bucket> _Buckets;
+	std::vector<WorkerTally> _WorkerTallies;
+
+	// By entity index. How far each body has moved up to the start of this frame, and that plus its reach.
+	std::vector<float> _Travelled;
+	std::vector<float> _Reach;
+
+	ContactCacheCounters _Counters;
+};
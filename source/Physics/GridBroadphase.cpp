@@ -0,0 +1,324 @@
+#include <algorithm> // for min and max
+#include <cfloat>
+#include <cmath>
+
+#include "GridBroadphase.h"
+#include "Narrowphase.h"
+
+#include "../Math/EuanityMath.h"
+
+#include "../Platform/ThreadPool.h"
+
+GridBroadphase::GridBroadphase(const Narrowphase& narrowphase,
+                               ThreadPool& workers,
+                               const Vector2& gameFieldDim,
+                               const PhysicsGridSettings& gridSettings)
+	: _Narrowphase(narrowphase),
+	  _Workers(workers),
+	  _GameFieldDim(gameFieldDim),
+	  _CellsX(0),
+	  _CellsY(0),
+	  _CellSizeX(0.0f),
+	  _CellSizeY(0.0f),
+	  _InvCellSizeX(0.0f),
+	  _InvCellSizeY(0.0f),
+	  _InsertedBodies(0),
+	  _LargestHalfExtent(0.0f),
+	  _Collisions(nullptr),
+	  _WorkerTallies(workers.WorkerCount())
+{
+	SetGridSettings(gridSettings);
+}
+
+void
+GridBroadphase::SetGridSettings(const PhysicsGridSettings& gridSettings)
+{
+	_GridSettings = gridSettings;
+
+	// Auto-tuned axes start from the old fixed grid until we've seen a frame.
+	ResizeGrid(gridSettings.CellsX > 0 ? gridSettings.CellsX : DEFAULT_CELLS,
+	           gridSettings.CellsY > 0 ? gridSettings.CellsY : DEFAULT_CELLS);
+}
+
+void
+GridBroadphase::ResizeGrid(const int cellsX, const int cellsY)
+{
+	_CellsX       = std::clamp(cellsX, 1, MAX_CELLS_PER_AXIS);
+	_CellsY       = std::clamp(cellsY, 1, MAX_CELLS_PER_AXIS);
+	_CellSizeX    = _GameFieldDim.x / static_cast<float>(_CellsX);
+	_CellSizeY    = _GameFieldDim.y / static_cast<float>(_CellsY);
+	_InvCellSizeX = 1.0f / _CellSizeX;
+	_InvCellSizeY = 1.0f / _CellSizeY;
+
+	for(auto& moveList : _MoveLists)
+		moveList.Clear();
+	_MoveLists.resize(static_cast<size_t>(_CellsX) * _CellsY);
+	_CellRanges.resize(_MoveLists.size());
+
+	for(auto y = 0; y < _CellsY; ++y)
+	{
+		for(auto x = 0; x < _CellsX; ++x)
+		{
+			_MoveLists[GetCellIndex(x, y)].SetHomeTile({ static_cast<int16_t>(x), static_cast<int16_t>(y) });
+		}
+	}
+}
+
+void
+GridBroadphase::AutoTuneGrid()
+{
+	if(_GridSettings.CellsX > 0 && _GridSettings.CellsY > 0)
+		return;
+
+	if(_InsertedBodies == 0)
+		return;
+
+	// Aim for square-ish cells holding TargetBodiesPerCell each...
+	const auto targetCells = static_cast<float>(_InsertedBodies) / static_cast<float>(std::max(_GridSettings.TargetBodiesPerCell, 1));
+	const auto cellArea    = _GameFieldDim.x * _GameFieldDim.y / std::max(targetCells, 1.0f);
+	const auto idealSize   = std::sqrt(cellArea);
+
+	// ...but never so small that the biggest body, padded, spans more than two cells a side.
+	const auto minimumSize = 2.0f * _LargestHalfExtent;
+	const auto cellSize    = std::max(idealSize, minimumSize);
+
+	const auto cellsX = _GridSettings.CellsX > 0 ? _GridSettings.CellsX : std::max(static_cast<int>(_GameFieldDim.x / cellSize), 1);
+	const auto cellsY = _GridSettings.CellsY > 0 ? _GridSettings.CellsY : std::max(static_cast<int>(_GameFieldDim.y / cellSize), 1);
+
+	// Leave it alone for small swings, so the population ticking up and down doesn't rebuild the grid every frame.
+	const auto isWorthChanging = [](const int current, const int wanted)
+	{
+		return std::abs(wanted - current) * 4 > current;
+	};
+	if(isWorthChanging(_CellsX, std::min(cellsX, MAX_CELLS_PER_AXIS)) || isWorthChanging(_CellsY, std::min(cellsY, MAX_CELLS_PER_AXIS)))
+	{
+		ResizeGrid(cellsX, cellsY);
+	}
+}
+
+int
+GridBroadphase::GetCellIndex(const int tileX, const int tileY) const
+{
+	return Math::Mod(tileY, _CellsY) * _CellsX + Math::Mod(tileX, _CellsX);
+}
+
+void
+GridBroadphase::ForEachNear(const AABB& bounds, const Visitor visit) const
+{
+	// Every body is filed into each cell its bounds touch, so the cells under the query hold everything it can reach.
+	// Capped the same as GetTileRange, so a query sees every copy a body of the same bounds would have been filed as.
+	const auto range = GetTileRange(bounds);
+	for(auto y = range.MinTileY; y <= range.MaxTileY; ++y)
+	{
+		for(auto x = range.MinTileX; x <= range.MaxTileX; ++x)
+		{
+			for(const auto& entry : _MoveLists[GetCellIndex(x, y)])
+				visit(entry);
+		}
+	}
+}
+
+void
+GridBroadphase::ForEachAlongSegment(const Vector2& start,
+                                    const Vector2& end,
+                                    const Visitor visit) const
+{
+	// Amanatides and Woo. Tiles are walked unwrapped, and GetCellIndex folds them back onto the grid, so a segment
+	// leaving one edge carries on from the other.
+	auto tileX           = static_cast<int>(std::floor(start.x * _InvCellSizeX));
+	auto tileY           = static_cast<int>(std::floor(start.y * _InvCellSizeY));
+	const auto lastTileX = static_cast<int>(std::floor(end.x * _InvCellSizeX));
+	const auto lastTileY = static_cast<int>(std::floor(end.y * _InvCellSizeY));
+
+	const auto delta = end - start;
+	const auto stepX = delta.x > 0.0f ? 1 : -1;
+	const auto stepY = delta.y > 0.0f ? 1 : -1;
+
+	// How far along the segment the next boundary on each axis is, and how far apart boundaries are, as fractions.
+	auto nextX     = FLT_MAX;
+	auto nextY     = FLT_MAX;
+	auto crossingX = FLT_MAX;
+	auto crossingY = FLT_MAX;
+	if(delta.x != 0.0f)
+	{
+		nextX     = ((tileX + (stepX > 0 ? 1 : 0)) * _CellSizeX - start.x) / delta.x;
+		crossingX = _CellSizeX / std::fabs(delta.x);
+	}
+	if(delta.y != 0.0f)
+	{
+		nextY     = ((tileY + (stepY > 0 ? 1 : 0)) * _CellSizeY - start.y) / delta.y;
+		crossingY = _CellSizeY / std::fabs(delta.y);
+	}
+
+	// Counting the steps from the end tile means rounding at a corner can't leave us walking forever.
+	const auto steps = std::abs(lastTileX - tileX) + std::abs(lastTileY - tileY);
+	for(auto step = 0; step <= steps; ++step)
+	{
+		for(const auto& entry : _MoveLists[GetCellIndex(tileX, tileY)])
+			visit(entry);
+
+		if(nextX < nextY)
+		{
+			tileX += stepX;
+			nextX += crossingX;
+		}
+		else
+		{
+			tileY += stepY;
+			nextY += crossingY;
+		}
+	}
+}
+
+GridBroadphase::TileRange
+GridBroadphase::GetTileRange(const AABB& aabb) const
+{
+	// Straight to the cell with a multiply. Tiles past either edge are wrapped copies, and a body can reach any
+	// number of cells past one when the grid is set by hand, so nothing is clamped. It's capped at one tile more
+	// than a grid's worth: the first and last tiles then land in the same cell, but a field apart, and on a grid one
+	// cell wide that's the only way a body hanging off the edge is there at both positions.
+	TileRange result;
+	result.MinTileX = static_cast<int>(std::floor(aabb.min.x * _InvCellSizeX));
+	result.MinTileY = static_cast<int>(std::floor(aabb.min.y * _InvCellSizeY));
+	result.MaxTileX = std::min(static_cast<int>(std::floor(aabb.max.x * _InvCellSizeX)), result.MinTileX + _CellsX);
+	result.MaxTileY = std::min(static_cast<int>(std::floor(aabb.max.y * _InvCellSizeY)), result.MinTileY + _CellsY);
+
+	return result;
+}
+
+void
+GridBroadphase::Insert(const MoveList::Entry& entry, const AABB& bounds)
+{
+	++_InsertedBodies;
+	_LargestHalfExtent = std::max(_LargestHalfExtent, 0.5f * std::max(bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y));
+
+	const auto range = GetTileRange(bounds);
+
+	// Enqueue the rigidbody into the appropriate moveLists by the chunk it's in. A copy wrapped round by some number
+	// of grids is shifted that many fields, so its first tile shifts by that many grids.
+	for(auto y = range.MinTileY; y <= range.MaxTileY; ++y)
+	{
+		// Wrap our Y coordinate if we have to.
+		const auto gridsY     = (y - Math::Mod(y, _CellsY)) / _CellsY;
+		const auto wrappedY   = entry.Pos.y - static_cast<float>(gridsY) * _GameFieldDim.y;
+		const auto firstTileY = range.MinTileY - gridsY * _CellsY;
+
+		for(auto x = range.MinTileX; x <= range.MaxTileX; ++x)
+		{
+			// Wrap the element in X if we have to.
+			const auto gridsX     = (x - Math::Mod(x, _CellsX)) / _CellsX;
+			const auto wrappedX   = entry.Pos.x - static_cast<float>(gridsX) * _GameFieldDim.x;
+			const auto firstTileX = range.MinTileX - gridsX * _CellsX;
+
+			// Calculate the chunk index and enqueue
+			auto wrapped = entry;
+			wrapped.Pos  = Vector2(wrappedX, wrappedY);
+
+			const auto chunkIndex = GetCellIndex(x, y);
+			_MoveLists[chunkIndex].Enqueue(wrapped, { static_cast<int16_t>(firstTileX), static_cast<int16_t>(firstTileY) });
+		}
+	}
+}
+
+void
+GridBroadphase::DetectCollisions(const float deltaTime, std::vector<std::vector<CollisionListEntry>>& collisions)
+{
+	_Collisions = &collisions;
+	_Stats      = BroadphaseStats();
+	for(auto& tally : _WorkerTallies)
+		tally.PairsTested = 0;
+
+	// Hand every occupied cell to the pool. Dense cells split themselves once they're sorted.
+	for(size_t i = 0; i < _MoveLists.size(); ++i)
+	{
+		++_Stats.CellOccupancy[BroadphaseStats::OccupancyBucket(_MoveLists[i].Size())];
+		if(_MoveLists[i].Size() > 0)
+			_Workers.Submit([this, i, deltaTime] { DetectInitialCollisions(i, deltaTime); });
+	}
+	_Workers.Wait();
+
+	for(const auto& tally : _WorkerTallies)
+		_Stats.PairsTested += tally.PairsTested;
+
+	_Collisions = nullptr;
+}
+
+void
+GridBroadphase::EndFrame()
+{
+	for(auto& moveList : _MoveLists)
+		moveList.Clear();
+
+	// The move lists are empty, so this is the one point the grid can safely change shape.
+	AutoTuneGrid();
+	_InsertedBodies    = 0;
+	_LargestHalfExtent = 0.0f;
+}
+
+void
+GridBroadphase::DetectInitialCollisions(const size_t cell, const float deltaTime)
+{
+	auto& moveList = _MoveLists[cell];
+
+	// Sort to get our MoveList in order.
+	moveList.SortByColliderType();
+
+	// The order of these has to match the order of enum ColliderType defined in ColliderType.h.
+	MoveList::ColliderRanges ranges;
+	ranges.ShipBegin = moveList.begin() + moveList.GetColliderCount(ColliderType::NONE);
+	ranges.ShipEnd   = ranges.BulletBegin = ranges.ShipBegin +
+		moveList.GetColliderCountsInRange(ColliderType::SHIP_1, ColliderType::SHIP_END),
+	ranges.BulletEnd = ranges.LargeBegin = ranges.BulletBegin +
+		moveList.GetColliderCountsInRange(ColliderType::BULLET, ColliderType::BOUNCY_BULLET);
+	ranges.LargeEnd  = ranges.MediumBegin = ranges.LargeBegin + moveList.GetColliderCount(ColliderType::LARGE_ASTEROID);
+	ranges.MediumEnd = ranges.SmallBegin  = ranges.MediumBegin + moveList.GetColliderCount(ColliderType::MEDIUM_ASTEROID);
+	ranges.SmallEnd  = moveList.end();
+	_CellRanges[cell] = ranges;
+
+	moveList.BuildLanes();
+
+	// Keep the first slice for ourselves and leave the rest on our deque for idle workers to steal.
+	const auto size = moveList.Size();
+	if(size > SPLIT_THRESHOLD)
+	{
+		for(auto first = SLICE_SIZE; first < size; first += SLICE_SIZE)
+		{
+			const auto last = std::min(first + SLICE_SIZE, size);
+			_Workers.Submit([this, cell, first, last, deltaTime] { DetectCollisionsInSlice(cell, first, last, deltaTime); });
+		}
+		DetectCollisionsInSlice(cell, 0, SLICE_SIZE, deltaTime);
+	}
+	else
+	{
+		DetectCollisionsInSlice(cell, 0, size, deltaTime);
+	}
+}
+
+void
+GridBroadphase::DetectCollisionsInSlice(const size_t cell, const size_t first, const size_t last, const float deltaTime)
+{
+	const auto& ranges = _CellRanges[cell];
+
+	// Clip every range to the slice. Ranges are back to back in sorted order, so each ends up whole, partial or empty.
+	const auto sliceBegin = _MoveLists[cell].begin() + first;
+	const auto sliceEnd   = _MoveLists[cell].begin() + last;
+	const auto clip       = [&](const std::vector<MoveList::Entry>::iterator it)
+	{
+		return std::clamp(it, sliceBegin, sliceEnd);
+	};
+
+	MoveList::ColliderRanges outer;
+	outer.ShipBegin   = clip(ranges.ShipBegin);
+	outer.ShipEnd     = clip(ranges.ShipEnd);
+	outer.BulletBegin = clip(ranges.BulletBegin);
+	outer.BulletEnd   = clip(ranges.BulletEnd);
+	outer.LargeBegin  = clip(ranges.LargeBegin);
+	outer.LargeEnd    = clip(ranges.LargeEnd);
+	outer.MediumBegin = clip(ranges.MediumBegin);
+	outer.MediumEnd   = clip(ranges.MediumEnd);
+	outer.SmallBegin  = clip(ranges.SmallBegin);
+	outer.SmallEnd    = clip(ranges.SmallEnd);
+
+	const auto worker = _Workers.CurrentWorker();
+	_WorkerTallies[worker].PairsTested += _Narrowphase.TestCell(_MoveLists[cell], outer, ranges, deltaTime, (*_Collisions)[worker]);
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+
+#include "../Math/Vector2.h"
+
+#include "Broadphase.h"
+
+class Narrowphase;
+class ThreadPool;
+
+// Resolution of the broadphase grid. Leave an axis at zero to have it tuned every frame from how many bodies were
+// enqueued and how big the biggest of them is.
+struct PhysicsGridSettings
+{
+	int CellsX = 0;
+	int CellsY = 0;
+
+	// What auto-tuning aims for. Fewer means more, smaller cells.
+	int TargetBodiesPerCell = 16;
+};
+
+// Files every body into each cell of a uniform grid its bounds touch, with wrapped copies for the cells past the
+// edges, then tests each cell on its own. Cells go to the pool as tasks, and dense ones are sliced up further.
+class GridBroadphase final : public Broadphase
+{
+public:
+	GridBroadphase(const Narrowphase& narrowphase,
+	               ThreadPool& workers,
+	               const Vector2& gameFieldDim,
+	               const PhysicsGridSettings& gridSettings = PhysicsGridSettings());
+
+	// Takes effect from the next frame, the current frame's bodies are already filed.
+	void SetGridSettings(const PhysicsGridSettings& gridSettings);
+	int GetCellsX() const { return _CellsX; }
+	int GetCellsY() const { return _CellsY; }
+
+	void Insert(const MoveList::Entry& entry, const AABB& bounds) override;
+	void DetectCollisions(float deltaTime, std::vector<std::vector<CollisionListEntry>>& collisions) override;
+	void ForEachNear(const AABB& bounds, Visitor visit) const override;
+	void ForEachAlongSegment(const Vector2& start,
+	                         const Vector2& end,
+	                         Visitor visit) const override;
+	const BroadphaseStats& GetStats() const override { return _Stats; }
+	void EndFrame() override;
+
+private:
+
+	// Tiles a body's bounds cover, unwrapped. Those outside the grid are wrapped copies of the far side, and there are
+	// never more than a grid's worth plus one on either axis.
+	struct TileRange
+	{
+		int MinTileX;
+		int MinTileY;
+		int MaxTileX;
+		int MaxTileY;
+	};
+	TileRange GetTileRange(const AABB& aabb) const;
+	int GetCellIndex(int tileX, int tileY) const;
+
+	void ResizeGrid(int cellsX, int cellsY);
+	void AutoTuneGrid();
+
+	// Sorts a cell's move list and tests it, handing slices of a dense cell out to other workers.
+	void DetectInitialCollisions(size_t cell, float deltaTime);
+
+	// Tests the entries in [first, last) of a sorted cell against everything they can hit in that cell.
+	void DetectCollisionsInSlice(size_t cell, size_t first, size_t last, float deltaTime);
+
+	static constexpr int DEFAULT_CELLS      = 8;
+	static constexpr int MAX_CELLS_PER_AXIS = 64;
+
+	// Cells with more entries than this are cut into slices of SLICE_SIZE for other workers to steal.
+	static constexpr size_t SPLIT_THRESHOLD = 256;
+	static constexpr size_t SLICE_SIZE      = 128;
+
+	const Narrowphase& _Narrowphase;
+	ThreadPool& _Workers;
+
+	const Vector2 _GameFieldDim;
+
+	PhysicsGridSettings _GridSettings;
+
+	int _CellsX;
+	int _CellsY;
+	float _CellSizeX;
+	float _CellSizeY;
+	float _InvCellSizeX;
+	float _InvCellSizeY;
+
+	// What was inserted this frame, for auto-tuning.
+	size_t _InsertedBodies;
+	float _LargestHalfExtent;
+
+	// One move list per cell, row by row.
+	std::vector<MoveList> _MoveLists;
+
+	// Each cell's collider ranges, once DetectInitialCollisions has sorted it.
+	std::vector<MoveList::ColliderRanges> _CellRanges;
+
+	// Where DetectCollisions is writing this frame.
+	std::vector<std::vector<CollisionListEntry>>* _Collisions;
+
+	// Kept apart so workers counting don't fight over a cache line.
+	struct alignas(64) WorkerTally
+	{
+		uint64_t PairsTested = 0;
+	};
+	std::vector<WorkerTally> _WorkerTallies;
+
+	BroadphaseStats _Stats;
+};
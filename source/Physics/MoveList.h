@@ -1,16 +1,32 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "../ECS/ComponentColumns.h"
+#include "../ECS/Entity.h"
+
+#include "../Math/Vector2.h"
+
+#include "ColliderType.h"
+
 class MoveList
 {
 public:
+	// Only what the broadphase and narrowphase read. Every body is copied in here once a frame, and again for each
+	// cell or ghost it's filed as, so it's kept to 24 bytes with 16-bit handles.
 	struct Entry
 	{
-		Rigidbody Rb;
 		Vector2 Pos;
+		Vector2 Velocity;
+		::Entity Entity;
+		ColliderType Type;
 
 		bool operator==(const Entry& other) const
 		{
-			return (Rb.entity == other.Rb.entity);
+			return (Entity == other.Entity);
 		}
 	};
 
@@ -28,15 +44,65 @@ public:
 		std::vector<Entry>::iterator SmallEnd;
 	};
 
-	void Enqueue(const Entry& entry)
+	// The tile an entry's padded bounds start in, counted in the frame of the cell it was filed into, so a copy
+	// wrapped in from the far edge starts off the near side of the cell.
+	struct Tile
+	{
+		int16_t X;
+		int16_t Y;
+	};
+
+	void Enqueue(const Entry& entry, const Tile firstTile = {})
 	{
 		_Data.push_back(entry);
-		++_ColliderCounts[static_cast<int>(entry.Rb.colliderType)];
+		_FirstTiles.push_back(firstTile);
+		++_ColliderCounts[static_cast<int>(entry.Type)];
+	}
+
+	// The tile this list is the cell for. Lists that don't set it, and don't give entries a tile, own every pair.
+	void SetHomeTile(const Tile home)
+	{
+		_Home = home;
+	}
+
+	// A pair whose bounds overlap sits in every cell they share. It belongs to the one where the later starting of
+	// the two begins, on both axes, so it is only ever tested once.
+	bool OwnsPair(const size_t a, const size_t b) const
+	{
+		return std::max(_FirstTiles[a].X, _FirstTiles[b].X) == _Home.X &&
+			std::max(_FirstTiles[a].Y, _FirstTiles[b].Y) == _Home.Y;
+	}
+
+	// Groups the entries by collider type, in enum order, keeping their order within a type. A counting sort, as
+	// we already know how many there are of each.
+	void SortByColliderType()
+	{
+		std::array<size_t, static_cast<int>(ColliderType::COUNT)> next;
+		size_t offset = 0;
+		for(size_t type = 0; type < next.size(); ++type)
+		{
+			next[type] = offset;
+			offset += _ColliderCounts[type];
+		}
+
+		_SortedData.resize(_Data.size());
+		_SortedFirstTiles.resize(_FirstTiles.size());
+		for(size_t i = 0; i < _Data.size(); ++i)
+		{
+			const auto to         = next[static_cast<int>(_Data[i].Type)]++;
+			_SortedData[to]       = _Data[i];
+			_SortedFirstTiles[to] = _FirstTiles[i];
+		}
+
+		_Data.swap(_SortedData);
+		_FirstTiles.swap(_SortedFirstTiles);
 	}
 
 	void Clear()
 	{
 		_Data.clear();
+		_FirstTiles.clear();
+		_Lanes.Clear();
 		for(auto& count : _ColliderCounts)
 			count = 0;
 	}
@@ -58,6 +124,40 @@ public:
 		return _Data.end();
 	}
 
+	// ReSharper disable once CppInconsistentNaming
+	std::vector<Entry>::const_iterator begin() const
+	{
+		return _Data.begin();
+	}
+
+	// ReSharper disable once CppInconsistentNaming
+	std::vector<Entry>::const_iterator end() const
+	{
+		return _Data.end();
+	}
+
+	size_t IndexOf(const std::vector<Entry>::const_iterator entry) const
+	{
+		return static_cast<size_t>(entry - _Data.cbegin());
+	}
+
+	// Copies every entry's position and velocity out into lanes, in the same order, for the SIMD narrowphase.
+	// Call again after reordering the entries.
+	void BuildLanes()
+	{
+		_Lanes.Clear();
+		_Lanes.Reserve(_Data.size());
+		for(const auto& entry : _Data)
+		{
+			_Lanes.PushBack(entry.Pos.x, entry.Pos.y, entry.Velocity.x, entry.Velocity.y);
+		}
+	}
+
+	const float* PosX() const { return _Lanes.Column<POS_X>().Data; }
+	const float* PosY() const { return _Lanes.Column<POS_Y>().Data; }
+	const float* VelX() const { return _Lanes.Column<VEL_X>().Data; }
+	const float* VelY() const { return _Lanes.Column<VEL_Y>().Data; }
+
 	int GetColliderCount(const ColliderType& colliderType) const
 	{
 		return _ColliderCounts[static_cast<int>(colliderType)];
@@ -76,6 +176,15 @@ public:
 
 private:
 	std::vector<Entry> _Data;
+	std::vector<Tile> _FirstTiles;
+	Tile _Home {};
+
+	// Kept between sorts so they don't allocate.
+	std::vector<Entry> _SortedData;
+	std::vector<Tile> _SortedFirstTiles;
+
+	enum Lane : size_t { POS_X, POS_Y, VEL_X, VEL_Y };
+	ComponentColumns<float, float, float, float> _Lanes;
 	std::array<int, static_cast<int>(ColliderType::COUNT)> _ColliderCounts = {};
 };
 
@@ -85,7 +194,7 @@ template <> struct hash<MoveList::Entry>
 {
 	size_t operator()(const MoveList::Entry& entry) const noexcept
 	{
-		return entry.Rb.entity.Hash();
+		return entry.Entity.Hash();
 	}
 };
 }
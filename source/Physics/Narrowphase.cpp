@@ -0,0 +1,309 @@
+#include "Narrowphase.h"
+#include "CollisionTests.h"
+
+#include "../ECS/TransformManager.h"
+
+#include "../Math/OBB.h"
+
+Narrowphase::Narrowphase(const TransformManager& transformManager)
+	: _TransformManager(transformManager)
+{
+}
+
+uint64_t
+Narrowphase::TestCell(const MoveList& cell,
+                      const MoveList::ColliderRanges& outer,
+                      const MoveList::ColliderRanges& ranges,
+                      const float deltaTime,
+                      std::vector<CollisionListEntry>& collisions) const
+{
+	ShipVsAsteroid(cell, outer, ranges, collisions, deltaTime);
+	AsteroidVsAsteroid(cell, outer, ranges, collisions, deltaTime);
+
+	// Every ship is tested against every asteroid, and every asteroid against the ones after it in the cell. The
+	// asteroid types are back to back, so that's everything up to the cell's end.
+	const auto ships           = static_cast<uint64_t>(outer.ShipEnd - outer.ShipBegin);
+	const auto asteroids       = static_cast<uint64_t>(outer.SmallEnd - outer.LargeBegin);
+	const auto cellAsteroids   = static_cast<uint64_t>(ranges.SmallEnd - ranges.LargeBegin);
+	const auto asteroidsToCome = static_cast<uint64_t>(ranges.SmallEnd - outer.LargeBegin);
+
+	return ships * cellAsteroids + asteroids * asteroidsToCome - asteroids * (asteroids + 1) / 2;
+}
+
+void
+Narrowphase::TestPair(const MoveList::Entry& a,
+                      const MoveList::Entry& b,
+                      const float deltaTime,
+                      std::vector<CollisionListEntry>& collisions) const
+{
+	if(a.Entity == b.Entity)
+		return;
+
+	// Lower collider type first, as the cell tests do, then lower entity, so a pair comes out the same whichever
+	// order the broadphase found it in.
+	const auto isAFirst = a.Type != b.Type
+		                      ? a.Type < b.Type
+		                      : a.Entity < b.Entity;
+	const auto& first  = isAFirst ? a : b;
+	const auto& second = isAFirst ? b : a;
+
+	const auto typeA = first.Type;
+	const auto typeB = second.Type;
+
+	// Ships, bullets and asteroids are only ever tested against asteroids.
+	if(typeA == ColliderType::NONE || typeB < ColliderType::LARGE_ASTEROID || typeB > ColliderType::SMOL_ASTEROID)
+		return;
+
+	CollisionListEntry entry;
+	entry.A           = first.Entity;
+	entry.EntityAType = typeA;
+	entry.MassA       = GetMassFromColliderType(typeA);
+	entry.B           = second.Entity;
+	entry.EntityBType = typeB;
+	entry.MassB       = GetMassFromColliderType(typeB);
+
+	if(ColliderUtils::IsPlayerShip(typeA))
+	{
+		const auto optionalShipTrans = _TransformManager.Get(first.Entity);
+		if(!optionalShipTrans.has_value())
+			return;
+
+		// Built at the entry's position rather than the transform's, so a wrapped copy is tested where it sits.
+		const OBB shipOBB(first.Pos, ColliderUtils::GetDimFromType(typeA) * 0.5f, optionalShipTrans->rot);
+		if(!CollisionTests::SweptOBBToCircle(shipOBB, first.Velocity, Circle(second.Pos, ColliderUtils::GetRadiusFromType(typeB)),
+		                                     second.Velocity, deltaTime, entry.TimeOfCollision))
+			return;
+
+		collisions.push_back(entry);
+		return;
+	}
+
+	const auto combinedRadii = ColliderUtils::GetRadiusFromType(typeA) + ColliderUtils::GetRadiusFromType(typeB);
+	if(CollisionTests::SweptCircleToCircle(first.Pos, first.Velocity, second.Pos, second.Velocity,
+	                                       0.0f, combinedRadii * combinedRadii, deltaTime, entry.TimeOfCollision))
+	{
+		collisions.push_back(entry);
+	}
+}
+
+void
+Narrowphase::ShipVsAsteroid(const MoveList& moveList,
+                            const MoveList::ColliderRanges& outer,
+                            const MoveList::ColliderRanges& ranges,
+                            std::vector<CollisionListEntry>& collisions,
+                            const float& deltaTime) const
+{
+	for(auto ship = outer.ShipBegin; ship != outer.ShipEnd; ++ship)
+	{
+		auto optionalShipTrans = _TransformManager.Get(ship->Entity);
+		if(!optionalShipTrans.has_value())
+			// @TODO: Are you ever going to write that logging module? Because this should be logged.
+			continue;
+		const auto shipRot = optionalShipTrans->rot;
+
+		auto shipDim = ColliderUtils::GetDimFromType(ship->Type);
+
+		// Built at the entry's position rather than the transform's, so a wrapped copy is tested where it sits.
+		OBB playerOBB(ship->Pos, shipDim * 0.5f, shipRot);
+
+		const auto shipIndex = moveList.IndexOf(ship);
+		OBBVsSpecificAsteroid(moveList, playerOBB, shipIndex, *ship, ranges.LargeBegin, ranges.LargeEnd, ColliderUtils::Large, collisions, deltaTime);
+		OBBVsSpecificAsteroid(moveList, playerOBB, shipIndex, *ship, ranges.MediumBegin, ranges.MediumEnd, ColliderUtils::Medium, collisions, deltaTime);
+		OBBVsSpecificAsteroid(moveList, playerOBB, shipIndex, *ship, ranges.SmallBegin, ranges.SmallEnd, ColliderUtils::Small, collisions, deltaTime);
+	}
+}
+
+void
+Narrowphase::OBBVsSpecificAsteroid(const MoveList& moveList,
+                                   const OBB& ship,
+                                   const size_t shipIndex,
+                                   const MoveList::Entry& shipEntry,
+                                   const std::vector<MoveList::Entry>::iterator asteroidBegin,
+                                   const std::vector<MoveList::Entry>::iterator asteroidEnd,
+                                   const float& asteroidRadius,
+                                   std::vector<CollisionListEntry>& collisions,
+                                   const float& deltaTime)
+{
+	for(auto Asteroid = asteroidBegin; Asteroid != asteroidEnd; ++Asteroid)
+	{
+		Circle collider(Asteroid->Pos, asteroidRadius);
+		float timeOfCollision;
+		if(CollisionTests::SweptOBBToCircle(ship, shipEntry.Velocity, collider, Asteroid->Velocity, deltaTime, timeOfCollision) &&
+			moveList.OwnsPair(shipIndex, moveList.IndexOf(Asteroid)))
+		{
+			CollisionListEntry entry;
+			entry.A           = shipEntry.Entity;
+			entry.EntityAType = shipEntry.Type;
+			entry.MassA       = GetMassFromColliderType(shipEntry.Type);
+			entry.B           = Asteroid->Entity;
+			entry.EntityBType = Asteroid->Type;
+			entry.MassB       = GetMassFromColliderType(Asteroid->Type);
+
+			entry.TimeOfCollision = timeOfCollision;
+
+			collisions.push_back(entry);
+		}
+	}
+}
+
+float
+Narrowphase::GetMassFromColliderType(const ColliderType& type)
+{
+	switch(type)
+	{
+		case ColliderType::LARGE_ASTEROID: return ASTEROID_MASSES[0];
+		case ColliderType::MEDIUM_ASTEROID: return ASTEROID_MASSES[1];
+		case ColliderType::SMOL_ASTEROID: return ASTEROID_MASSES[2];
+	}
+
+	if(ColliderUtils::IsPlayerShip(type))
+	{
+		return ASTEROID_MASSES[1] / 2;
+	}
+
+	// Objects are zero mass by default.
+	return 0;
+}
+
+void
+Narrowphase::AsteroidVsAsteroid(const MoveList& moveList,
+                                const MoveList::ColliderRanges& outer,
+                                const MoveList::ColliderRanges& ranges,
+                                std::vector<CollisionListEntry>& collisions,
+                                const float& deltaTime)
+{
+	for(auto large = outer.LargeBegin; large != outer.LargeEnd; ++large)
+	{
+		// Large Vs Large
+		const auto LargeVsLargeSqRadius =
+			(ColliderUtils::Large + ColliderUtils::Large) *
+			(ColliderUtils::Large + ColliderUtils::Large);
+
+		// @NOTE: starting the range at large+1 guarantees that we don't check A against itself,
+		// and that we don't repeat test pairs that have already been computed.
+		CircleVsCircles(moveList, large, ASTEROID_MASSES[0],
+		                large + 1, ranges.LargeEnd,
+		                ASTEROID_MASSES[0], LargeVsLargeSqRadius, deltaTime,
+		                ColliderType::LARGE_ASTEROID, ColliderType::LARGE_ASTEROID,
+		                collisions);
+
+
+		// Large Vs Medium
+		const auto LargeVsMediumSqRadius =
+			(ColliderUtils::Large + ColliderUtils::Medium) *
+			(ColliderUtils::Large + ColliderUtils::Medium);
+
+		CircleVsCircles(moveList, large, ASTEROID_MASSES[0],
+		                ranges.MediumBegin, ranges.MediumEnd,
+		                ASTEROID_MASSES[1], LargeVsMediumSqRadius, deltaTime,
+		                ColliderType::LARGE_ASTEROID, ColliderType::MEDIUM_ASTEROID,
+		                collisions);
+
+
+		// Large Vs Small
+		const auto LargeVsSmallSqRadius =
+			(ColliderUtils::Large + ColliderUtils::Small) *
+			(ColliderUtils::Large + ColliderUtils::Small);
+
+		CircleVsCircles(moveList, large, ASTEROID_MASSES[0],
+		                ranges.SmallBegin, ranges.SmallEnd,
+		                ASTEROID_MASSES[2], LargeVsSmallSqRadius, deltaTime,
+		                ColliderType::LARGE_ASTEROID, ColliderType::SMOL_ASTEROID,
+		                collisions);
+	}
+
+	for(auto Medium = outer.MediumBegin; Medium != outer.MediumEnd; ++Medium)
+	{
+		// Medium Vs Medium
+		const auto MediumVsMediumSqRadius =
+			(ColliderUtils::Medium + ColliderUtils::Medium) *
+			(ColliderUtils::Medium + ColliderUtils::Medium);
+
+		// @NOTE: starting the range at medium+1 guarantees that we don't check A against itself,
+		// and that we don't repeat test pairs that have already been computed.
+		CircleVsCircles(moveList, Medium, ASTEROID_MASSES[1],
+		                Medium + 1, ranges.MediumEnd,
+		                ASTEROID_MASSES[1], MediumVsMediumSqRadius, deltaTime,
+		                ColliderType::MEDIUM_ASTEROID, ColliderType::MEDIUM_ASTEROID,
+		                collisions);
+
+
+		// Medium Vs Small
+		const auto MediumVsSmallSqRadius =
+			(ColliderUtils::Medium + ColliderUtils::Small) *
+			(ColliderUtils::Medium + ColliderUtils::Small);
+
+		CircleVsCircles(moveList, Medium, ASTEROID_MASSES[1],
+		                ranges.SmallBegin, ranges.SmallEnd,
+		                ASTEROID_MASSES[2], MediumVsSmallSqRadius, deltaTime,
+		                ColliderType::MEDIUM_ASTEROID, ColliderType::SMOL_ASTEROID,
+		                collisions);
+	}
+
+
+	for(auto Small = outer.SmallBegin; Small != outer.SmallEnd; ++Small)
+	{
+		// Small Vs Small
+		const auto SmallVsSmallSqRadius =
+			(ColliderUtils::Small + ColliderUtils::Small) *
+			(ColliderUtils::Small + ColliderUtils::Small);
+
+		// @NOTE: starting the range at small+1 guarantees that we don't check A against itself,
+		// and that we don't repeat test pairs that have already been computed.
+		CircleVsCircles(moveList, Small, ASTEROID_MASSES[2],
+		                Small + 1, ranges.SmallEnd,
+		                ASTEROID_MASSES[2], SmallVsSmallSqRadius, deltaTime,
+		                ColliderType::SMOL_ASTEROID, ColliderType::SMOL_ASTEROID,
+		                collisions);
+	}
+}
+
+
+void
+Narrowphase::CircleVsCircles(const MoveList& Cell,
+                             const std::vector<MoveList::Entry>::iterator Circle,
+                             const float& CircleMass,
+                             const std::vector<MoveList::Entry>::iterator CirclesBegin,
+                             const std::vector<MoveList::Entry>::iterator CirclesEnd,
+                             const float& CirclesMass,
+                             const float& RadiusPlusRadiusSquared,
+                             const float& DeltaTime,
+                             const ColliderType& TypeA,
+                             const ColliderType& TypeB,
+                             std::vector<CollisionListEntry>& Collisions)
+{
+	if(CirclesBegin == CirclesEnd)
+		return;
+
+	// Check our first circle against every circle in the range that we were passed
+	const auto CircleIndex = Cell.IndexOf(Circle);
+	const auto First       = Cell.IndexOf(CirclesBegin);
+	CollisionTests::SweptCircleToCircles(
+		Circle->Pos, Circle->Velocity,
+		Cell.PosX() + First, Cell.PosY() + First,
+		Cell.VelX() + First, Cell.VelY() + First,
+		static_cast<size_t>(CirclesEnd - CirclesBegin),
+		RadiusPlusRadiusSquared, DeltaTime,
+		[&](const size_t Index, const float TimeOfCollision)
+		{
+			const auto& CircleB = CirclesBegin[Index];
+			if(Circle->Entity == CircleB.Entity)
+				return;
+
+			// Only hits are checked, so the cost of ownership doesn't touch the SIMD sweep.
+			if(!Cell.OwnsPair(CircleIndex, First + Index))
+				return;
+
+			CollisionListEntry Col;
+			Col.A           = Circle->Entity;
+			Col.EntityAType = TypeA;
+			Col.MassA       = CircleMass;
+
+			Col.B           = CircleB.Entity;
+			Col.EntityBType = TypeB;
+			Col.MassB       = CirclesMass;
+
+			Col.TimeOfCollision = TimeOfCollision;
+			Collisions.push_back(Col);
+		});
+}
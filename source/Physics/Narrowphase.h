@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "ColliderType.h"
+#include "CollisionListEntry.h"
+#include "MoveList.h"
+
+class OBB;
+class TransformManager;
+
+// The exact tests, run on whatever a broadphase thinks might be touching. Only reads, so every worker can share one.
+class Narrowphase
+{
+public:
+	explicit Narrowphase(const TransformManager& transformManager);
+
+	// Tests the bodies in `outer` against the whole of a cell, whose move list is sorted by collider type and split
+	// up by `ranges`. A dense cell can be shared out by handing slices of it to different calls as `outer`. Hits
+	// are only kept for pairs the cell owns. Returns how many pairs it tested.
+	uint64_t TestCell(const MoveList& cell,
+	              const MoveList::ColliderRanges& outer,
+	              const MoveList::ColliderRanges& ranges,
+	              float deltaTime,
+	              std::vector<CollisionListEntry>& collisions) const;
+
+	// Tests two bodies, given in either order. Pairs the cell tests would never try, like bullet against bullet, are
+	// skipped the same way here.
+	void TestPair(const MoveList::Entry& a,
+	              const MoveList::Entry& b,
+	              float deltaTime,
+	              std::vector<CollisionListEntry>& collisions) const;
+
+	static float GetMassFromColliderType(const ColliderType& type);
+
+private:
+
+	// Each loops over the bodies in `outer` and tests them against the full cell in `ranges`.
+
+	// OBB Collisions
+
+	void ShipVsAsteroid(const MoveList& moveList,
+	                    const MoveList::ColliderRanges& outer,
+	                    const MoveList::ColliderRanges& ranges,
+	                    std::vector<CollisionListEntry>& collisions,
+	                    const float& deltaTime) const;
+	static void OBBVsSpecificAsteroid(const MoveList& moveList,
+	                                  const OBB& ship,
+	                                  size_t shipIndex,
+	                                  const MoveList::Entry& shipEntry,
+	                                  const std::vector<MoveList::Entry>::iterator asteroidBegin,
+	                                  const std::vector<MoveList::Entry>::iterator asteroidEnd,
+	                                  const float& asteroidRadius,
+	                                  std::vector<CollisionListEntry>& collisions,
+	                                  const float& deltaTime);
+
+
+	// Circle Collisions
+
+	static void AsteroidVsAsteroid(const MoveList& moveList,
+	                               const MoveList::ColliderRanges& outer,
+	                               const MoveList::ColliderRanges& ranges,
+	                               std::vector<CollisionListEntry>& collisions,
+	                               const float& deltaTime);
+
+	// Tests against the batch in one SIMD sweep over the move list's lanes.
+	static void CircleVsCircles(const MoveList& Cell,
+	                            std::vector<MoveList::Entry>::iterator Circle,
+	                            const float& CircleMass,
+	                            std::vector<MoveList::Entry>::iterator CirclesBegin,
+	                            std::vector<MoveList::Entry>::iterator CirclesEnd,
+	                            const float& CirclesMass,
+	                            const float& RadiusPlusRadiusSquared,
+	                            const float& DeltaTime,
+	                            const ColliderType& TypeA,
+	                            const ColliderType& TypeB,
+	                            std::vector<CollisionListEntry>& Collisions);
+
+	inline static const float ASTEROID_MASSES[] { 16.0f, 4.0f, 1.0f };
+
+	const TransformManager& _TransformManager;
+};
@@ -0,0 +1,174 @@
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "NarrowphaseBenchmark.h"
+#include "ColliderType.h"
+#include "CollisionTests.h"
+
+namespace
+{
+constexpr std::array<size_t, 3> ASTEROID_COUNTS = { 1000, 10000, 100000 };
+
+// Roughly what one busy grid cell holds, so every asteroid gets tested against this many others.
+constexpr size_t CANDIDATES = 64;
+
+constexpr float FIELD_SIZE = 2500.0f;
+constexpr float CELL_SIZE  = 250.0f;
+constexpr float MAX_SPEED  = 200.0f;
+constexpr float DELTA_TIME = 1.0f / 60.0f;
+
+struct Lanes
+{
+	std::vector<float> PosX;
+	std::vector<float> PosY;
+	std::vector<float> VelX;
+	std::vector<float> VelY;
+};
+
+struct Result
+{
+	double Seconds = 0.0;
+	size_t Hits    = 0;
+	double TimeSum = 0.0;
+};
+
+// Asteroids come in cell-sized clumps, so each one's candidates are mostly real neighbours and a fair share of pairs
+// hit, the same as in a busy grid cell.
+Lanes MakeAsteroids(const size_t count)
+{
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> cell(0.0f, FIELD_SIZE - CELL_SIZE);
+	std::uniform_real_distribution<float> offset(0.0f, CELL_SIZE);
+	std::uniform_real_distribution<float> velocity(-MAX_SPEED, MAX_SPEED);
+
+	const auto padded = count + CANDIDATES;
+
+	Lanes lanes;
+	lanes.PosX.resize(padded);
+	lanes.PosY.resize(padded);
+	lanes.VelX.resize(padded);
+	lanes.VelY.resize(padded);
+
+	auto cellX = 0.0f;
+	auto cellY = 0.0f;
+	for(size_t i = 0; i < padded; ++i)
+	{
+		if(i % CANDIDATES == 0)
+		{
+			cellX = cell(random);
+			cellY = cell(random);
+		}
+		lanes.PosX[i] = cellX + offset(random);
+		lanes.PosY[i] = cellY + offset(random);
+		lanes.VelX[i] = velocity(random);
+		lanes.VelY[i] = velocity(random);
+	}
+	return lanes;
+}
+
+// Circles lined up on the x axis against one at the origin, closing head on at 100 units a frame with a combined
+// radius of 30. Even ones start 100 + 2i away, so they touch after (70 + 2i) / 100 of the frame. Odd ones move away
+// and must miss. Enough of them to fill whole SIMD vectors and leave some for the scalar tail.
+template <typename Kernel> bool IsTimeOfImpactExact(Kernel&& kernel)
+{
+	constexpr size_t COUNT    = 11;
+	constexpr float SPEED     = 100.0f / DELTA_TIME;
+	constexpr float RADII_SUM = 30.0f;
+
+	std::array<float, COUNT> posX {};
+	std::array<float, COUNT> posY {};
+	std::array<float, COUNT> velX {};
+	std::array<float, COUNT> velY {};
+	for(size_t i = 0; i < COUNT; ++i)
+	{
+		posX[i] = 100.0f + 2.0f * static_cast<float>(i);
+		velX[i] = i % 2 == 0 ? -SPEED : SPEED;
+	}
+
+	size_t hits  = 0;
+	auto isExact = true;
+	kernel(Vector2::Zero(), Vector2::Zero(), posX.data(), posY.data(), velX.data(), velY.data(), COUNT,
+	       RADII_SUM * RADII_SUM, DELTA_TIME,
+	       [&](const size_t index, const float time)
+	       {
+		       ++hits;
+		       const auto expected = (posX[index] - RADII_SUM) / 100.0f;
+		       isExact &= index % 2 == 0 && std::abs(time - expected) < 1e-4f;
+	       });
+	return isExact && hits == (COUNT + 1) / 2;
+}
+
+template <typename Kernel> Result Measure(const Lanes& lanes, const size_t count, Kernel&& kernel)
+{
+	constexpr auto radiiSq = (ColliderUtils::Medium + ColliderUtils::Medium) * (ColliderUtils::Medium + ColliderUtils::Medium);
+
+	Result result;
+	const auto start = std::chrono::steady_clock::now();
+	for(size_t i = 0; i < count; ++i)
+	{
+		const Vector2 center(lanes.PosX[i], lanes.PosY[i]);
+		const Vector2 velocity(lanes.VelX[i], lanes.VelY[i]);
+		kernel(center, velocity,
+		       &lanes.PosX[i + 1], &lanes.PosY[i + 1], &lanes.VelX[i + 1], &lanes.VelY[i + 1], CANDIDATES - 1,
+		       radiiSq, DELTA_TIME,
+		       [&](size_t, const float time)
+		       {
+			       ++result.Hits;
+			       result.TimeSum += time;
+		       });
+	}
+	result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+}
+
+void
+NarrowphaseBenchmark::Run()
+{
+#if defined(EUANITY_SIMD_AVX2)
+	const auto* simdName = "AVX2";
+#elif defined(EUANITY_SIMD_SSE)
+	const auto* simdName = "SSE";
+#else
+	const auto* simdName = "none, scalar fallback";
+#endif
+	std::cout << "Narrowphase benchmark, SIMD: " << simdName << "\n";
+
+	const auto isScalarExact = IsTimeOfImpactExact([](auto&&... args)
+	{
+		CollisionTests::SweptCircleToCirclesScalar(args...);
+	});
+	const auto isSimdExact = IsTimeOfImpactExact([](auto&&... args)
+	{
+		CollisionTests::SweptCircleToCircles(args...);
+	});
+	std::cout << "  Head-on time of impact:   Scalar " << (isScalarExact ? "exact" : "MISMATCH!")
+		<< "   SIMD " << (isSimdExact ? "exact" : "MISMATCH!") << "\n";
+
+	for(const auto count : ASTEROID_COUNTS)
+	{
+		const auto lanes = MakeAsteroids(count);
+
+		const auto scalar = Measure(lanes, count, [](auto&&... args)
+		{
+			CollisionTests::SweptCircleToCirclesScalar(args...);
+		});
+		const auto simd = Measure(lanes, count, [](auto&&... args)
+		{
+			CollisionTests::SweptCircleToCircles(args...);
+		});
+
+		const auto pairs    = static_cast<double>(count * (CANDIDATES - 1));
+		const auto isAgreed = scalar.Hits == simd.Hits && std::abs(scalar.TimeSum - simd.TimeSum) < 1e-3;
+
+		std::cout << "  " << count << " asteroids, " << scalar.Hits << " hits:"
+			<< "   Scalar " << scalar.Seconds * 1e9 / pairs << " ns."
+			<< "   SIMD " << simd.Seconds * 1e9 / pairs << " ns per pair."
+			<< "   Speedup " << scalar.Seconds / simd.Seconds << "x."
+			<< (isAgreed ? "" : "   MISMATCH!") << "\n";
+	}
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// Debug benchmark for the swept circle narrowphase, toggled from the debug keys. Times the scalar and SIMD
+// kernels over the same random asteroids at 1k, 10k and 100k, each tested against a cell's worth of neighbours,
+// checks they agree, and prints the cost per pair. First checks both against a head-on case whose time of impact is
+// known exactly. Blocks until it's done.
+namespace NarrowphaseBenchmark
+{
+void Run();
+}
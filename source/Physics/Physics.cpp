@@ -1,118 +1,70 @@
-#include <unordered_set>
 #include <algorithm> // for min and max
+#include <cmath>
 
 #include "Physics.h"
 #include "ColliderType.h"
-#include "CollisionTests.h"
+#include "GridBroadphase.h"
+#include "SweepAndPrune.h"
 
 #include "../ECS/RigidbodyManager.h"
 #include "../ECS/TransformManager.h"
 
 #include "../Math/EuanityMath.h"
-#include "../Math/OBB.h"
 #include "../Math/Vector2.h"
 
-Physics::Physics(TransformManager& transformManager, RigidbodyManager& rigidbodyManager, const Vector2& gameFieldDim)
+#include "../Platform/ThreadPool.h"
+
+Physics::Physics(TransformManager& transformManager,
+                 RigidbodyManager& rigidbodyManager,
+                 ThreadPool& workers,
+                 const Vector2& gameFieldDim,
+                 const BroadphaseType broadphaseType,
+                 const PhysicsGridSettings& gridSettings)
 	: _TransformManager(transformManager),
 	  _RigidbodyManager(rigidbodyManager),
+	  _Workers(workers),
 	  _GameFieldDim(gameFieldDim),
-	  _ChunkSizeX(gameFieldDim.x / CHUNKS_X),
-	  _ChunkSizeY(gameFieldDim.y / CHUNKS_Y),
-	  _MoveLists()
+	  _BroadphaseType(broadphaseType),
+	  _Narrowphase(transformManager),
+	  _ContactCache(workers.WorkerCount()),
+	  _Broadphase(MakeBroadphase(broadphaseType, _Narrowphase, _ContactCache, workers, gameFieldDim, gridSettings)),
+	  _Queries(*_Broadphase, _Projectiles, transformManager, workers, gameFieldDim),
+	  _WorkerCollisions(workers.WorkerCount()),
+	  _WorkerProjectiles(workers.WorkerCount()),
+	  _ClaimsSize(0),
+	  _ClaimBase(1),
+	  _IsParallelSolveAbandoned(false),
+	  _ParallelEventsProcessed(0),
+	  _SerialSolveFrames(0),
+	  _EventBudget(DEFAULT_EVENT_BUDGET),
+	  _WorkerBusyAtDetect(workers.WorkerCount()),
+	  _NearbyQuery(0)
 {
+	_FrameStats.DetectCollisionsWorkerMs.resize(workers.WorkerCount());
 }
 
-bool
-Physics::IsOverlappingAnything(const Circle& testCircle, const ColliderType ignore)
+std::unique_ptr<Broadphase>
+Physics::MakeBroadphase(const BroadphaseType broadphaseType,
+                        const Narrowphase& narrowphase,
+                        ContactCache& contactCache,
+                        ThreadPool& workers,
+                        const Vector2& gameFieldDim,
+                        const PhysicsGridSettings& gridSettings)
 {
-	const auto boundingAABB =
-		AABB(testCircle.Center.y - testCircle.Radius, testCircle.Center.y + testCircle.Radius,
-		     testCircle.Center.y - testCircle.Radius, testCircle.Center.y + testCircle.Radius);
-
-	// @TODO: We can shave off some work by only checking the circle and not it's bounding box.
-	// Get tile range based on our bounding AABB.
-	const auto [MinTileX, MinTileY, MaxTileX, MaxTileY] = GetTileRange(boundingAABB);
-
-	for(auto y = MinTileY; y <= MaxTileY; ++y)
+	switch(broadphaseType)
 	{
-		// Wrap our Y coordinate if we have to.
-		auto wrappedY = testCircle.Center.y;
-		if(y < 0)
-		{
-			wrappedY += _GameFieldDim.y;
-		}
-		else if(y >= CHUNKS_Y)
-		{
-			wrappedY -= _GameFieldDim.y;
-		}
-
-		for(auto x = MinTileX; x <= MaxTileX; ++x)
-		{
-			// Wrap the element in X if we have to.
-			auto wrappedX = testCircle.Center.x;
-			if(x < 0)
-				wrappedX += _GameFieldDim.x;
-			else if(x >= CHUNKS_X)
-				wrappedX -= _GameFieldDim.x;
-
-			// Calculate the chunk index and enqueue
-			const auto chunkIndex = Math::Mod(y, CHUNKS_Y) * CHUNKS_X + Math::Mod(x, CHUNKS_X);
-
-			const Circle wrappedCircle(Vector2(wrappedX, wrappedY), testCircle.Radius);
-			const float maximumRadius = ColliderUtils::GetRadiusFromType(ColliderType::LARGEST_POSSIBLE_COLLIDER);
-			for(auto entry = _MoveLists[chunkIndex].begin();
-			    entry != _MoveLists[chunkIndex].end(); ++entry)
-			{
-				if(entry->Rb.colliderType == ignore)
-					continue;
-				const Circle entryCircle(entry->Pos, maximumRadius);
-				if(CollisionTests::CircleToCircle(wrappedCircle, entryCircle))
-				{
-					return true;
-				}
-			}
-		}
+		case BroadphaseType::SWEEP_AND_PRUNE:
+			return std::make_unique<SweepAndPrune>(narrowphase, contactCache, workers, gameFieldDim);
+		case BroadphaseType::GRID:
+		default:
+			return std::make_unique<GridBroadphase>(narrowphase, workers, gameFieldDim, gridSettings);
 	}
-
-	return false;
 }
 
-Physics::TileRange
-Physics::GetTileRange(const AABB& aabb) const
+bool
+Physics::IsOverlappingAnything(const Circle& testCircle, const ColliderType ignore) const
 {
-	TileRange result;
-	auto accumulator = Vector2::Zero();
-	result.MinTileX  = -1;
-	result.MinTileY  = -1;
-	while(accumulator.x < aabb.min.x)
-	{
-		accumulator.x += _ChunkSizeX;
-		++result.MinTileX;
-	}
-	while(accumulator.y < aabb.min.y)
-	{
-		accumulator.y += _ChunkSizeY;
-		++result.MinTileY;
-	}
-	// @NOTE: Logic here is a bit tricky. At this point, startTile indicates the
-	//  "lowest" tile that the AABB overlaps, and accumulator is sitting in the
-	//  maximum corner of that tile.
-
-	// Using the same method, we advance the max accumulator to find the maximum.
-	result.MaxTileX = result.MinTileX;
-	result.MaxTileY = result.MinTileY;
-	while(accumulator.x < aabb.max.x)
-	{
-		accumulator.x += _ChunkSizeX;
-		++result.MaxTileX;
-	}
-	while(accumulator.y < aabb.max.y)
-	{
-		accumulator.y += _ChunkSizeY;
-		++result.MaxTileY;
-	}
-
-	return result;
+	return _Queries.IsOverlappingAnything(testCircle, QueryFilter::Excluding(ignore));
 }
 
 void
@@ -126,436 +78,605 @@ Physics::Enqueue(const Rigidbody& rb, const float& deltaTime)
 		//@TODO: Error check in case of RB with no Transform?
 	}
 
-	const auto rbTrans = optionalRbTrans.value();
+	Enqueue(rb, optionalRbTrans.value(), deltaTime);
+}
+
+void
+Physics::Enqueue(const Rigidbody& rb, const Transform& rbTrans, const float& deltaTime)
+{
+	if(_Moves.empty())
+		_EnqueueStart = Clock::now();
 
-	auto rbAABB = ColliderUtils::GetAABB(rb.colliderType, rbTrans.pos);
+	const MoveList::Entry entry { rbTrans.pos, rb.velocity, rb.entity, rb.colliderType };
+	_Moves.push_back(rb);
 
-	// Pad the AABB by the velocity, and a small safety margin.
-	const auto deltaPosition = rb.velocity * deltaTime;
+	if(ColliderUtils::IsBullet(rb.colliderType))
+	{
+		_Projectiles.push_back(entry);
+		return;
+	}
 
-	const auto padding = 15.0f;
+	_Broadphase->Insert(entry, GetEnqueueBounds(rb.colliderType, rbTrans.pos, rb.velocity, deltaTime));
+}
 
-	rbAABB.min.x = std::min(rbAABB.min.x, rbAABB.min.x + deltaPosition.x - padding);
-	rbAABB.min.y = std::min(rbAABB.min.y, rbAABB.min.y + deltaPosition.y - padding);
-	rbAABB.max.x = std::max(rbAABB.max.x, rbAABB.max.x + deltaPosition.x + padding);
-	rbAABB.max.y = std::max(rbAABB.max.y, rbAABB.max.y + deltaPosition.y + padding);
+AABB
+Physics::GetEnqueueBounds(const ColliderType& type,
+                          const Vector2& position,
+                          const Vector2& velocity,
+                          const float deltaTime)
+{
+	auto bounds = ColliderUtils::GetAABB(type, position);
 
-	const auto range = GetTileRange(rbAABB);
+	// Pad the AABB by the velocity, and a small safety margin.
+	const auto deltaPosition = velocity * deltaTime;
 
-	// Enqueue the rigidbody into the appropriate moveLists by the chunk it's in.
-	for(auto y = range.MinTileY; y <= range.MaxTileY; ++y)
-	{
-		// Wrap our Y coordinate if we have to.
-		auto wrappedY = rbTrans.pos.y;
-		if(y < 0)
-			wrappedY += _GameFieldDim.y;
-		else if(y >= CHUNKS_Y)
-			wrappedY -= _GameFieldDim.y;
+	const auto padding = ENQUEUE_PADDING;
 
-		for(auto x = range.MinTileX; x <= range.MaxTileX; ++x)
-		{
-			// Wrap the element in X if we have to.
-			auto wrappedX = rbTrans.pos.x;
-			if(x < 0)
-				wrappedX += _GameFieldDim.x;
-			else if(x >= CHUNKS_X)
-				wrappedX -= _GameFieldDim.x;
-
-			// Calculate the chunk index and enqueue
-			const auto chunkIndex = Math::Mod(y, CHUNKS_Y) * CHUNKS_X + Math::Mod(x, CHUNKS_X);
-			_MoveLists[chunkIndex].Enqueue({ rb, Vector2(wrappedX, wrappedY) });
-		}
-	}
+	bounds.min.x = std::min(bounds.min.x, bounds.min.x + deltaPosition.x - padding);
+	bounds.min.y = std::min(bounds.min.y, bounds.min.y + deltaPosition.y - padding);
+	bounds.max.x = std::max(bounds.max.x, bounds.max.x + deltaPosition.x + padding);
+	bounds.max.y = std::max(bounds.max.y, bounds.max.y + deltaPosition.y + padding);
+
+	return bounds;
 }
 
 void
 Physics::Simulate(const float& deltaTime)
 {
+	const auto simulateStart = Clock::now();
+
+	++_FrameStats.Frame;
+	_FrameStats.EnqueueMs =
+		_Moves.empty() ? 0.0 : std::chrono::duration<double, std::milli>(simulateStart - _EnqueueStart).count();
+	_FrameStats.MergeCollisionsMs    = 0.0;
+	_FrameStats.ResolveEventsMs      = 0.0;
+	_FrameStats.Bodies               = static_cast<uint32_t>(_Moves.size());
+	_FrameStats.Projectiles          = static_cast<uint32_t>(_Projectiles.size());
+	_FrameStats.SecondaryPairsTested = 0;
+	_FrameStats.SolverIterations     = 0;
+
 	_CollisionReport.clear(); // Clear last frame's report.
 
-	// Start our worker threads churning through the Initial collision tests.
-	for(auto i = 0; i < CHUNK_COUNT; ++i)
+	for(auto& collisions : _WorkerCollisions)
+		collisions.clear();
 
-		_Workers[i] = std::async([this, i, deltaTime]() -> std::vector<CollisionListEntry>
-		{
-			return DetectInitialCollisions(_MoveLists[i], deltaTime);
-		});
+	_ContactCache.BeginFrame();
+	for(const auto& move : _Moves)
+	{
+		if(ContactCache::IsCacheable(move.colliderType))
+			_ContactCache.SetReach(move.entity, move.velocity.Length() * deltaTime);
+	}
+
+	// Nothing else runs on the pool during DetectCollisions, so whatever the workers were busy with is ours.
+	for(size_t i = 0; i < _WorkerBusyAtDetect.size(); ++i)
+		_WorkerBusyAtDetect[i] = _Workers.GetBusyNanoseconds(i);
 
-	for(auto& worker : _Workers)
+	auto stageStart = Clock::now();
+	_Broadphase->DetectCollisions(deltaTime, _WorkerCollisions);
+	_FrameStats.DetectCollisionsMs = MillisecondsSince(stageStart);
+
+	for(size_t i = 0; i < _WorkerBusyAtDetect.size(); ++i)
 	{
-		auto result = worker.get();
-		_CollisionList.reserve(_CollisionList.size() + result.size());
-		_CollisionList.insert(_CollisionList.end(), result.begin(), result.end());
+		const auto busy = _Workers.GetBusyNanoseconds(i) - _WorkerBusyAtDetect[i];
+		_FrameStats.DetectCollisionsWorkerMs[i] = static_cast<double>(busy) * 1e-6;
 	}
 
-	RemoveDuplicateCollisions();
+	_ContactCache.Commit();
 
-	if(_CollisionList.size() > 0) // Most frames feature zero collisions.
+	stageStart = Clock::now();
+	for(auto& scratch : _WorkerProjectiles)
+		scratch.PairsTested = 0;
+
+	for(size_t first = 0; first < _Projectiles.size(); first += PROJECTILE_BATCH)
 	{
-		auto solverIterations = 0;
-		do
-		{
-			// From each collision, generate new moves based on physical interactions
-			auto resolvedThisIteration = ResolveUpdatedMovement(deltaTime);
+		const auto last = std::min(first + PROJECTILE_BATCH, _Projectiles.size());
+		_Workers.Submit([this, first, last, deltaTime] { CastProjectiles(first, last, deltaTime); });
+	}
+	_Workers.Wait();
 
-			// Clear the collision list and the dirty set.
-			_CollisionReport.reserve(_CollisionReport.size() + _CollisionList.size());
-			_CollisionReport.insert(_CollisionReport.end(), _CollisionList.begin(), _CollisionList.end());
-			_CollisionList.clear();
-			_DirtyList.clear();
+	_FrameStats.CastProjectilesMs     = MillisecondsSince(stageStart);
+	_FrameStats.ProjectilePairsTested = 0;
+	for(const auto& scratch : _WorkerProjectiles)
+		_FrameStats.ProjectilePairsTested += scratch.PairsTested;
 
-			//  Check the NEW elements in resolved list against the full move list, looking for further collisions.
-			DetectSecondaryCollisions(resolvedThisIteration);
+	stageStart = Clock::now();
+	for(auto& collisions : _WorkerCollisions)
+	{
+		_CollisionList.insert(_CollisionList.end(), collisions.begin(), collisions.end());
+	}
+	_FrameStats.Hits = static_cast<uint32_t>(_CollisionList.size());
 
-			// Step 7.5. Integrate the new resolved entries into the list.
-			_ResolvedList.reserve(_ResolvedList.size() + resolvedThisIteration.size());
-			_ResolvedList.insert(_ResolvedList.end(), resolvedThisIteration.begin(), resolvedThisIteration.end());
+	_SolverCounters.EventsProcessed = 0;
+	_SolverCounters.StaleEvents     = 0;
+	_SolverCounters.EventsDropped   = 0;
+	_SolverCounters.IslandQueues    = 0;
 
-			// Step 8. If the collision list is empty, continue. Otherwise, loop..
-			++solverIterations;
-		} while(_CollisionList.size() > 0 && solverIterations < MAX_SOLVER_ITERATIONS);
+	if(_CollisionList.size() > 0) // Most frames feature zero collisions.
+	{
+		const auto queueCount         = BuildIslandQueues();
+		_FrameStats.MergeCollisionsMs = MillisecondsSince(stageStart);
 
-		std::sort(_ResolvedList.begin(), _ResolvedList.end(),
-		          [](const ResolvedListEntry& a, ResolvedListEntry& b) -> bool
-		          {
-			          return a.Time < b.Time;
-		          });
+		stageStart = Clock::now();
+		ResolveEvents(queueCount, deltaTime);
+		_FrameStats.ResolveEventsMs = MillisecondsSince(stageStart);
 	}
 
+	stageStart = Clock::now();
 	FinalizeMoves(deltaTime);
+	_FrameStats.FinalizeMovesMs = MillisecondsSince(stageStart);
+
+	const auto& broadphaseStats = _Broadphase->GetStats();
+	_FrameStats.PairsTested     = broadphaseStats.PairsTested;
+	_FrameStats.CellOccupancy   = broadphaseStats.CellOccupancy;
+	_FrameStats.Collisions      = static_cast<uint32_t>(_CollisionReport.size());
+	_FrameStats.Solver          = _SolverCounters;
+	_FrameStats.ContactCache    = _ContactCache.GetCounters();
+	_FrameStats.SimulateMs      = MillisecondsSince(simulateStart);
 }
 
 
 void
 Physics::EndFrame()
 {
-	for(auto& moveList : _MoveLists)
-		moveList.Clear();
+	_Broadphase->EndFrame();
+	_Moves.clear();
+	_Projectiles.clear();
 
 	_CollisionList.clear();
-	_ResolvedList.clear();
-	_DirtyList.clear();
-}
 
-std::vector<Physics::CollisionListEntry>
-Physics::DetectInitialCollisions(MoveList& moveList, const float& deltaTime) const
-{
-	std::vector<CollisionListEntry> collisions;
-	if(moveList.Size() == 0)
-		return collisions;
-
-	// Sort to get our MoveList in order.
-	std::sort(moveList.begin(), moveList.end(), [](const MoveList::Entry& a, const MoveList::Entry& b) -> bool
-	{
-		return a.Rb.colliderType < b.Rb.colliderType;
-	});
-
-	// The order of these has to match the order of enum ColliderType defined in ColliderType.h.
-	MoveList::ColliderRanges ranges;
-	ranges.ShipBegin = moveList.begin() + moveList.GetColliderCount(ColliderType::NONE);
-	ranges.ShipEnd   = ranges.BulletBegin = ranges.ShipBegin +
-		moveList.GetColliderCountsInRange(ColliderType::SHIP_1, ColliderType::SHIP_END),
-	ranges.BulletEnd = ranges.LargeBegin = ranges.BulletBegin +
-		moveList.GetColliderCountsInRange(ColliderType::BULLET, ColliderType::BOUNCY_BULLET);
-	ranges.LargeEnd  = ranges.MediumBegin = ranges.LargeBegin + moveList.GetColliderCount(ColliderType::LARGE_ASTEROID);
-	ranges.MediumEnd = ranges.SmallBegin  = ranges.MediumBegin + moveList.GetColliderCount(ColliderType::MEDIUM_ASTEROID);
-	ranges.SmallEnd  = moveList.end();
-
-	ShipVsAsteroid(ranges, collisions);
-	BulletVsAsteroid(ranges, collisions, deltaTime);
-	AsteroidVsAsteroid(ranges, collisions, deltaTime);
-
-	return collisions;
+	for(const auto& resolved : _ResolvedList)
+		_ResolvedIndex[resolved.Entity.Index()] = 0;
+	_ResolvedList.clear();
 }
 
 void
-Physics::RemoveDuplicateCollisions()
+Physics::CastProjectiles(const size_t first, const size_t last, const float deltaTime)
 {
-	//@TODO: Does this mean we should be storing the collisions as sets to begin with? How does that perform when we join the threads at the start?
-	//@NOTE: In testing this actually turned out to be the fastest method.
-	std::unordered_set<CollisionListEntry> tempSet;
+	auto& collisions = _WorkerCollisions[_Workers.CurrentWorker()];
+	auto& scratch    = _WorkerProjectiles[_Workers.CurrentWorker()];
+	auto& hits       = scratch.Hits;
 
-	tempSet.reserve(_CollisionList.size());
-
-	for(auto& collisionEntry : _CollisionList)
-		tempSet.insert(collisionEntry);
+	for(auto i = first; i < last; ++i)
+	{
+		const auto& bullet = _Projectiles[i];
+		const auto end     = bullet.Pos + bullet.Velocity * deltaTime;
 
-	_CollisionList.assign(tempSet.begin(), tempSet.end());
+		// Cells can hold a wrapped copy of a body, so bring whatever we find round to the bullet's side of the field.
+		hits.clear();
+		_Broadphase->ForEachAlongSegment(bullet.Pos, end, [&](const MoveList::Entry& entry)
+		{
+			auto wrapped = entry;
+			wrapped.Pos  = bullet.Pos + WrapDelta(entry.Pos - bullet.Pos);
+			_Narrowphase.TestPair(bullet, wrapped, deltaTime, hits);
+			++scratch.PairsTested;
+		});
 
-	//@NOTE: @BUGFIX: This sort is "necessary" to prevent render order issues in the case where asteroids overlap.
-	// in the case of "perfect" physics, we shouldn't ever have overlaps. But we decided to allow them and to be as
-	// graceful as we possibly can be when it *does* happen.
-	sort(_CollisionList.begin(), _CollisionList.end());
+		// An asteroid filed in more than one of the cells crossed is hit the same way in each.
+		std::sort(hits.begin(), hits.end(), [](const CollisionListEntry& a, const CollisionListEntry& b)
+		{
+			return a.A != b.A ? a.A < b.A : a.B < b.B;
+		});
+		collisions.insert(collisions.end(), hits.begin(), std::unique(hits.begin(), hits.end()));
+	}
 }
 
-void
-Physics::ShipVsAsteroid(const MoveList::ColliderRanges& ranges, std::vector<CollisionListEntry>& collisions) const
+size_t
+Physics::BuildIslandQueues()
 {
-	for(auto ship = ranges.ShipBegin; ship != ranges.ShipEnd; ++ship)
+	// Too few to be worth sharing out.
+	if(_Workers.WorkerCount() < 2 || _CollisionList.size() < 2 * RESOLVE_BATCH)
 	{
-		auto optionalShipTrans = _TransformManager.Get(ship->Rb.entity);
-		if(!optionalShipTrans.has_value())
-			// @TODO: Are you ever going to write that logging module? Because this should be logged.
-			continue;
-		auto [shipPos, shipRot] = optionalShipTrans.value();
+		BuildSingleQueue();
+		return 1;
+	}
 
-		auto shipDim = ColliderUtils::GetDimFromType(ship->Rb.colliderType);
+	// The last try ran into another queue or the budget, and this one most likely would too.
+	if(_SerialSolveFrames > 0)
+	{
+		--_SerialSolveFrames;
+		BuildSingleQueue();
+		return 1;
+	}
 
-		OBB playerOBB(shipPos, shipDim * 0.5f, shipRot);
+	// Earliest first, so the islands and queues come out the same whichever worker found what.
+	std::sort(_CollisionList.begin(), _CollisionList.end(), IsEarlier);
 
-		OBBVsSpecificAsteroid(playerOBB, ship->Rb, ranges.LargeBegin, ranges.LargeEnd, ColliderUtils::Large, collisions);
-		OBBVsSpecificAsteroid(playerOBB, ship->Rb, ranges.MediumBegin, ranges.MediumEnd, ColliderUtils::Medium, collisions);
-		OBBVsSpecificAsteroid(playerOBB, ship->Rb, ranges.SmallBegin, ranges.SmallEnd, ColliderUtils::Small, collisions);
+	uint32_t largestIndex = 0;
+	for(const auto& collision : _CollisionList)
+	{
+		largestIndex = std::max(largestIndex, static_cast<uint32_t>(collision.A.Index()));
+		largestIndex = std::max(largestIndex, static_cast<uint32_t>(collision.B.Index()));
 	}
-}
 
-void
-Physics::OBBVsSpecificAsteroid(const OBB& ship,
-                               const Rigidbody& shipRigidbody,
-                               const std::vector<MoveList::Entry>::iterator asteroidBegin,
-                               const std::vector<MoveList::Entry>::iterator asteroidEnd,
-                               const float& asteroidRadius,
-                               std::vector<CollisionListEntry>& collisions)
-{
-	for(auto Asteroid = asteroidBegin; Asteroid != asteroidEnd; ++Asteroid)
+	if(largestIndex >= _IslandParent.size())
 	{
-		Circle collider(Asteroid->Pos, asteroidRadius);
-		if(CollisionTests::OBBToCircle(ship, collider))
-		{
-			CollisionListEntry entry;
-			entry.A           = shipRigidbody.entity;
-			entry.EntityAType = shipRigidbody.colliderType;
-			entry.MassA       = GetMassFromColliderType(shipRigidbody.colliderType);
-			entry.B           = Asteroid->Rb.entity;
-			entry.EntityBType = Asteroid->Rb.colliderType;
-			entry.MassB       = GetMassFromColliderType(Asteroid->Rb.colliderType);
+		_IslandParent.resize(static_cast<size_t>(largestIndex) + 1);
+		_IslandQueueIds.resize(static_cast<size_t>(largestIndex) + 1);
+	}
 
-			entry.TimeOfCollision = 0.0f; // Made-up.
+	// Only the bodies in a collision are ever looked at, so only they need resetting.
+	for(const auto& collision : _CollisionList)
+	{
+		const auto a     = static_cast<uint32_t>(collision.A.Index());
+		const auto b     = static_cast<uint32_t>(collision.B.Index());
+		_IslandParent[a] = a;
+		_IslandParent[b] = b;
+	}
 
-			collisions.push_back(entry);
+	// The lower index always becomes the root, so the islands come out the same whatever order they're joined in.
+	for(const auto& collision : _CollisionList)
+	{
+		const auto rootA = FindIsland(static_cast<uint32_t>(collision.A.Index()));
+		const auto rootB = FindIsland(static_cast<uint32_t>(collision.B.Index()));
+		if(rootA < rootB)
+			_IslandParent[rootB] = rootA;
+		else if(rootB < rootA)
+			_IslandParent[rootA] = rootB;
+	}
+
+	// Count each island's collisions at its root, then hand the islands out to queues as they're first seen. Once an
+	// island has its queue, the root holds that instead, flagged so it isn't taken for a count.
+	constexpr uint32_t ASSIGNED = 1u << 31;
+	for(const auto& collision : _CollisionList)
+		_IslandQueueIds[FindIsland(static_cast<uint32_t>(collision.A.Index()))] = 0;
+	for(const auto& collision : _CollisionList)
+		++_IslandQueueIds[FindIsland(static_cast<uint32_t>(collision.A.Index()))];
+
+	size_t queueCount  = 0;
+	size_t queueFilled = RESOLVE_BATCH;
+	for(const auto& collision : _CollisionList)
+	{
+		auto& queueId = _IslandQueueIds[FindIsland(static_cast<uint32_t>(collision.A.Index()))];
+		if((queueId & ASSIGNED) == 0)
+		{
+			if(queueFilled >= RESOLVE_BATCH)
+			{
+				OpenQueue(queueCount++);
+				queueFilled = 0;
+			}
+			queueFilled += queueId;
+			queueId = ASSIGNED | static_cast<uint32_t>(queueCount - 1);
 		}
+		_IslandQueues[queueId & ~ASSIGNED].Events.push_back({ collision, 0, 0 });
 	}
-}
 
-float
-Physics::GetMassFromColliderType(const ColliderType& type)
-{
-	switch(type)
+	// One island, or near enough, so nothing to run side by side.
+	if(queueCount == 1)
+	{
+		_IslandQueues[0].Events.clear();
+		BuildSingleQueue();
+		return 1;
+	}
+
+	// Everything a queue can reach was filed or enqueued this frame, so sizing for those means nothing the queues
+	// share has to grow while they run.
+	size_t bodySlots = 0;
+	for(const auto& move : _Moves)
+		bodySlots = std::max(bodySlots, static_cast<size_t>(move.entity.Index()) + 1);
+
+	if(bodySlots > _ClaimsSize)
 	{
-		case ColliderType::LARGE_ASTEROID: return ASTEROID_MASSES[0];
-		case ColliderType::MEDIUM_ASTEROID: return ASTEROID_MASSES[1];
-		case ColliderType::SMOL_ASTEROID: return ASTEROID_MASSES[2];
+		_ClaimsSize = std::max(bodySlots, _ClaimsSize * 2);
+		_Claims     = std::make_unique<std::atomic<uint32_t>[]>(_ClaimsSize);
 	}
+	if(bodySlots > _ResolvedIndex.size())
+		_ResolvedIndex.resize(bodySlots, 0);
+	if(bodySlots > _NearbyStamps.size())
+		_NearbyStamps.resize(bodySlots, 0);
 
-	if(ColliderUtils::IsPlayerShip(type))
+	if(_ClaimBase > UINT32_MAX - queueCount)
 	{
-		return ASTEROID_MASSES[1] / 2;
+		for(size_t i = 0; i < _ClaimsSize; ++i)
+			_Claims[i].store(0, std::memory_order_relaxed);
+		_ClaimBase = 1;
 	}
 
-	// Objects are zero mass by default.
-	return 0;
+	// Each queue starts out with its own islands' bodies.
+	for(size_t i = 0; i < queueCount; ++i)
+	{
+		auto& queue = _IslandQueues[i];
+		queue.Claim = _ClaimBase + static_cast<uint32_t>(i);
+		for(const auto& event : queue.Events)
+		{
+			_Claims[event.Collision.A.Index()].store(queue.Claim, std::memory_order_relaxed);
+			_Claims[event.Collision.B.Index()].store(queue.Claim, std::memory_order_relaxed);
+		}
+		std::make_heap(queue.Events.begin(), queue.Events.end(), IsLater);
+	}
+
+	return queueCount;
 }
 
-void
-Physics::BulletVsAsteroid(const MoveList::ColliderRanges& ranges,
-                          std::vector<CollisionListEntry>& collisions,
-                          const float& deltaTime)
+uint32_t
+Physics::FindIsland(uint32_t index)
 {
-	constexpr float bulletMass = 0; // Fuck it, bullets don't have mass. I have decided this.
-
-	for(auto bullet = ranges.BulletBegin; bullet != ranges.BulletEnd; ++bullet)
-	{
-		const auto bulletVsLargeRadius =
-			(ColliderUtils::Bullet + ColliderUtils::Large) *
-			(ColliderUtils::Bullet + ColliderUtils::Large);
-		CircleVsCircles(*bullet, ColliderUtils::Bullet, bulletMass,
-		                ranges.LargeBegin, ranges.LargeEnd,
-		                ASTEROID_MASSES[0], bulletVsLargeRadius, deltaTime,
-		                bullet->Rb.colliderType, ColliderType::LARGE_ASTEROID,
-		                collisions);
-
-		const auto BulletVsMediumRadius =
-			(ColliderUtils::Bullet + ColliderUtils::Medium) *
-			(ColliderUtils::Bullet + ColliderUtils::Medium);
-		CircleVsCircles(*bullet, ColliderUtils::Bullet, bulletMass,
-		                ranges.MediumBegin, ranges.MediumEnd,
-		                ASTEROID_MASSES[1], BulletVsMediumRadius, deltaTime,
-		                bullet->Rb.colliderType, ColliderType::MEDIUM_ASTEROID,
-		                collisions);
-
-		const auto BulletVsSmallRadius =
-			(ColliderUtils::Bullet + ColliderUtils::Small) *
-			(ColliderUtils::Bullet + ColliderUtils::Small);
-
-		CircleVsCircles(*bullet, ColliderUtils::Bullet, bulletMass,
-		                ranges.SmallBegin, ranges.SmallEnd,
-		                ASTEROID_MASSES[2], BulletVsSmallRadius, deltaTime,
-		                bullet->Rb.colliderType, ColliderType::SMOL_ASTEROID,
-		                collisions);
+	// Path halving.
+	while(_IslandParent[index] != index)
+	{
+		_IslandParent[index] = _IslandParent[_IslandParent[index]];
+		index                = _IslandParent[index];
 	}
+
+	return index;
+}
+
+void
+Physics::BuildSingleQueue()
+{
+	auto& queue = OpenQueue(0);
+	for(const auto& collision : _CollisionList)
+		queue.Events.push_back({ collision, 0, 0 });
+	std::make_heap(queue.Events.begin(), queue.Events.end(), IsLater);
+}
+
+Physics::IslandQueue&
+Physics::OpenQueue(const size_t index)
+{
+	if(index >= _IslandQueues.size())
+		_IslandQueues.resize(index + 1);
+
+	auto& queue = _IslandQueues[index];
+	queue.Events.clear();
+	queue.Resolved.clear();
+	queue.Report.clear();
+	queue.Counters             = PhysicsSolverCounters();
+	queue.Iterations           = 0;
+	queue.SecondaryPairsTested = 0;
+	queue.Claim                = 0;
+	return queue;
 }
 
 void
-Physics::AsteroidVsAsteroid(const MoveList::ColliderRanges& ranges,
-                            std::vector<CollisionListEntry>& collisions,
-                            const float& deltaTime)
+Physics::ResolveEvents(const size_t queueCount, const float& deltaTime)
 {
-	for(auto large = ranges.LargeBegin; large != ranges.LargeEnd; ++large)
+	//@NOTE: @BUGFIX: Going in time order is "necessary" to prevent render order issues in the case where asteroids
+	// overlap. in the case of "perfect" physics, we shouldn't ever have overlaps. But we decided to allow them and
+	// to be as graceful as we possibly can be when it *does* happen.
+	//
+	// Islands that share no bodies go through their own queues side by side, each in time order. A body that changes
+	// course is predicted again against whatever is near its new path, though, which can be another island's. So each
+	// queue claims every body it looks at, and if two queues ever want the same one, or between them go over the
+	// budget, what they did is thrown away and it's all done again in one queue, as are the next few frames. Either
+	// way it comes out the same.
+	if(queueCount > 1)
 	{
-		// Large Vs Large
-		const auto LargeVsLargeSqRadius =
-			(ColliderUtils::Large + ColliderUtils::Large) *
-			(ColliderUtils::Large + ColliderUtils::Large);
+		if(ResolveIslandsInParallel(queueCount, deltaTime))
+		{
+			_CollisionList.clear();
+			return;
+		}
 
-		// @NOTE: starting the range at large+1 guarantees that we don't check A against itself,
-		// and that we don't repeat test pairs that have already been computed.
-		CircleVsCircles(*large, ColliderUtils::Large, ASTEROID_MASSES[0],
-		                large + 1, ranges.LargeEnd,
-		                ASTEROID_MASSES[0], LargeVsLargeSqRadius, deltaTime,
-		                ColliderType::LARGE_ASTEROID, ColliderType::LARGE_ASTEROID,
-		                collisions);
+		++_SolverCounters.IslandRetries;
+		_SerialSolveFrames = SERIAL_SOLVE_FRAMES;
+		BuildSingleQueue();
+	}
 
+	auto& queue = _IslandQueues[0];
+	ResolveQueue(queue, deltaTime);
 
-		// Large Vs Medium
-		const auto LargeVsMediumSqRadius =
-			(ColliderUtils::Large + ColliderUtils::Medium) *
-			(ColliderUtils::Large + ColliderUtils::Medium);
+	// The stamps already point into the queue's list, so it can be taken over whole.
+	_ResolvedList.swap(queue.Resolved);
+	_CollisionReport.swap(queue.Report);
 
-		CircleVsCircles(*large, ColliderUtils::Large, ASTEROID_MASSES[0],
-		                ranges.MediumBegin, ranges.MediumEnd,
-		                ASTEROID_MASSES[1], LargeVsMediumSqRadius, deltaTime,
-		                ColliderType::LARGE_ASTEROID, ColliderType::MEDIUM_ASTEROID,
-		                collisions);
+	_SolverCounters.EventsProcessed += queue.Counters.EventsProcessed;
+	_SolverCounters.StaleEvents += queue.Counters.StaleEvents;
+	_SolverCounters.EventsDropped += queue.Counters.EventsDropped;
+	_SolverCounters.BudgetExhaustions += queue.Counters.BudgetExhaustions;
+	_FrameStats.SolverIterations += queue.Iterations;
+	_FrameStats.SecondaryPairsTested += queue.SecondaryPairsTested;
 
+	if(queue.Counters.BudgetExhaustions != 0)
+		_SerialSolveFrames = SERIAL_SOLVE_FRAMES;
 
-		// Large Vs Small
-		const auto LargeVsSmallSqRadius =
-			(ColliderUtils::Large + ColliderUtils::Small) *
-			(ColliderUtils::Large + ColliderUtils::Small);
+	_CollisionList.clear();
+}
+
+bool
+Physics::ResolveIslandsInParallel(const size_t queueCount, const float& deltaTime)
+{
+	_IsParallelSolveAbandoned.store(false, std::memory_order_relaxed);
+	_ParallelEventsProcessed.store(0, std::memory_order_relaxed);
 
-		CircleVsCircles(*large, ColliderUtils::Large, ASTEROID_MASSES[0],
-		                ranges.SmallBegin, ranges.SmallEnd,
-		                ASTEROID_MASSES[2], LargeVsSmallSqRadius, deltaTime,
-		                ColliderType::LARGE_ASTEROID, ColliderType::SMOL_ASTEROID,
-		                collisions);
+	for(size_t i = 1; i < queueCount; ++i)
+		_Workers.Submit([this, i, deltaTime] { ResolveQueue(_IslandQueues[i], deltaTime); });
+	ResolveQueue(_IslandQueues[0], deltaTime);
+	_Workers.Wait();
+
+	// Everything claimed this frame reads as unclaimed from here on.
+	_ClaimBase += static_cast<uint32_t>(queueCount);
+
+	if(_IsParallelSolveAbandoned.load(std::memory_order_relaxed))
+	{
+		for(size_t i = 0; i < queueCount; ++i)
+		{
+			for(const auto& resolved : _IslandQueues[i].Resolved)
+				_ResolvedIndex[resolved.Entity.Index()] = 0;
+		}
+		return false;
 	}
 
-	for(auto Medium = ranges.MediumBegin; Medium != ranges.MediumEnd; ++Medium)
+	// Always take the queue whose next collision is earliest, as one queue holding them all would have. A queue's own
+	// order is kept rather than sorted, as it can resolve a collision at the same time as the one before with a lower
+	// pair, and each resolved collision left exactly two states behind it.
+	const auto isLaterHead = [this](const MergeHead& a, const MergeHead& b)
 	{
-		// Medium Vs Medium
-		const auto MediumVsMediumSqRadius =
-			(ColliderUtils::Medium + ColliderUtils::Medium) *
-			(ColliderUtils::Medium + ColliderUtils::Medium);
+		return IsEarlier(_IslandQueues[b.Queue].Report[b.Index], _IslandQueues[a.Queue].Report[a.Index]);
+	};
 
-		// @NOTE: starting the range at medium+1 guarantees that we don't check A against itself,
-		// and that we don't repeat test pairs that have already been computed.
-		CircleVsCircles(*Medium, ColliderUtils::Medium, ASTEROID_MASSES[1],
-		                Medium + 1, ranges.MediumEnd,
-		                ASTEROID_MASSES[1], MediumVsMediumSqRadius, deltaTime,
-		                ColliderType::MEDIUM_ASTEROID, ColliderType::MEDIUM_ASTEROID,
-		                collisions);
+	_MergeHeads.clear();
+	for(size_t i = 0; i < queueCount; ++i)
+	{
+		if(!_IslandQueues[i].Report.empty())
+			_MergeHeads.push_back({ static_cast<uint32_t>(i), 0 });
+	}
+	std::make_heap(_MergeHeads.begin(), _MergeHeads.end(), isLaterHead);
 
+	while(!_MergeHeads.empty())
+	{
+		std::pop_heap(_MergeHeads.begin(), _MergeHeads.end(), isLaterHead);
+		auto head = _MergeHeads.back();
+		_MergeHeads.pop_back();
 
-		// Medium Vs Small
-		const auto MediumVsSmallSqRadius =
-			(ColliderUtils::Medium + ColliderUtils::Small) *
-			(ColliderUtils::Medium + ColliderUtils::Small);
+		const auto& queue = _IslandQueues[head.Queue];
+		_CollisionReport.push_back(queue.Report[head.Index]);
+		AddResolved(_ResolvedList, queue.Resolved[2 * static_cast<size_t>(head.Index)]);
+		AddResolved(_ResolvedList, queue.Resolved[2 * static_cast<size_t>(head.Index) + 1]);
 
-		CircleVsCircles(*Medium, ColliderUtils::Medium, ASTEROID_MASSES[1],
-		                ranges.SmallBegin, ranges.SmallEnd,
-		                ASTEROID_MASSES[2], MediumVsSmallSqRadius, deltaTime,
-		                ColliderType::MEDIUM_ASTEROID, ColliderType::SMOL_ASTEROID,
-		                collisions);
+		if(++head.Index < queue.Report.size())
+		{
+			_MergeHeads.push_back(head);
+			std::push_heap(_MergeHeads.begin(), _MergeHeads.end(), isLaterHead);
+		}
 	}
 
-
-	for(auto Small = ranges.SmallBegin; Small != ranges.SmallEnd; ++Small)
+	for(size_t i = 0; i < queueCount; ++i)
 	{
-		// Small Vs Small
-		const auto SmallVsSmallSqRadius =
-			(ColliderUtils::Small + ColliderUtils::Small) *
-			(ColliderUtils::Small + ColliderUtils::Small);
-
-		// @NOTE: starting the range at small+1 guarantees that we don't check A against itself,
-		// and that we don't repeat test pairs that have already been computed.
-		CircleVsCircles(*Small, ColliderUtils::Small, ASTEROID_MASSES[2],
-		                Small + 1, ranges.SmallEnd,
-		                ASTEROID_MASSES[2], SmallVsSmallSqRadius, deltaTime,
-		                ColliderType::SMOL_ASTEROID, ColliderType::SMOL_ASTEROID,
-		                collisions);
+		const auto& queue = _IslandQueues[i];
+		_SolverCounters.EventsProcessed += queue.Counters.EventsProcessed;
+		_SolverCounters.StaleEvents += queue.Counters.StaleEvents;
+		_FrameStats.SolverIterations += queue.Iterations;
+		_FrameStats.SecondaryPairsTested += queue.SecondaryPairsTested;
 	}
-}
+	_SolverCounters.IslandQueues = static_cast<uint32_t>(queueCount);
 
+	return true;
+}
 
 void
-Physics::CircleVsCircles(const MoveList::Entry& Circle,
-                         const float& CircleRadius,
-                         const float& CircleMass,
-                         const std::vector<MoveList::Entry>::iterator CirclesBegin,
-                         const std::vector<MoveList::Entry>::iterator CirclesEnd,
-                         const float& CirclesMass,
-                         const float& RadiusPlusRadiusSquared,
-                         const float& DeltaTime,
-                         const ColliderType& TypeA,
-                         const ColliderType& TypeB,
-                         std::vector<CollisionListEntry>& Collisions)
+Physics::ResolveQueue(IslandQueue& queue, const float& deltaTime)
 {
-	// Check our first circle against every circle in the range that we were passed
-	for(auto CircleB = CirclesBegin; CircleB != CirclesEnd; ++CircleB)
+	auto& events = queue.Events;
+	while(!events.empty())
 	{
-		if(Circle.Rb.entity == CircleB->Rb.entity)
-			continue;
+		if(queue.Claim != 0 && _IsParallelSolveAbandoned.load(std::memory_order_relaxed))
+			break;
 
-		float TimeOfCollision;
-		if(CollisionTests::SweptCircleToCircle(
-			Circle.Pos, Circle.Rb.velocity,
-			CircleB->Pos, CircleB->Rb.velocity,
-			CircleRadius, RadiusPlusRadiusSquared, DeltaTime, TimeOfCollision))
+		std::pop_heap(events.begin(), events.end(), IsLater);
+		const auto event = events.back();
+		events.pop_back();
+		++queue.Iterations;
+
+		// One of them has changed course since this was predicted, and been predicted again from where it went.
+		if(IsStale(event))
 		{
-			CollisionListEntry Col;
-			Col.A           = Circle.Rb.entity;
-			Col.EntityAType = TypeA;
-			Col.MassA       = CircleMass;
+			++queue.Counters.StaleEvents;
+			continue;
+		}
 
-			Col.B           = CircleB->Rb.entity;
-			Col.EntityBType = TypeB;
-			Col.MassB       = CirclesMass;
+		queue.Report.push_back(event.Collision);
 
-			Col.TimeOfCollision = TimeOfCollision;
-			Collisions.push_back(Col);
+		if(queue.Claim != 0)
+		{
+			// Side by side, only the total can be held to the budget. Going over it means starting again in one queue,
+			// which can drop what's left in time order.
+			if(_ParallelEventsProcessed.fetch_add(1, std::memory_order_relaxed) >= _EventBudget)
+			{
+				_IsParallelSolveAbandoned.store(true, std::memory_order_relaxed);
+				break;
+			}
 		}
+		else if(queue.Counters.EventsProcessed == _EventBudget)
+		{
+			// Out of budget. Gameplay still hears about everything that's left, but it all passes through.
+			++queue.Counters.BudgetExhaustions;
+			++queue.Counters.EventsDropped;
+			for(const auto& remaining : events)
+			{
+				if(IsStale(remaining))
+					continue;
+
+				queue.Report.push_back(remaining.Collision);
+				++queue.Counters.EventsDropped;
+			}
+			events.clear();
+			break;
+		}
+
+		++queue.Counters.EventsProcessed;
+
+		const auto firstNew = queue.Resolved.size();
+		for(const auto& resolved : ResolveMove(queue, deltaTime, event.Collision))
+			AddResolved(queue.Resolved, resolved);
+
+		// Only these two have changed course, so only their pairs need predicting again.
+		DetectSecondaryCollisions(queue, firstNew, deltaTime);
+	}
+
+	// Whatever's left if it was stopped early.
+	events.clear();
+}
+
+bool
+Physics::TryClaim(IslandQueue& queue, const Entity& entity)
+{
+	if(queue.Claim == 0)
+		return true;
+
+	// Nothing but the claim is handed between queues, so relaxed is enough.
+	auto& owner  = _Claims[entity.Index()];
+	auto current = owner.load(std::memory_order_relaxed);
+	while(current < _ClaimBase)
+	{
+		if(owner.compare_exchange_weak(current, queue.Claim, std::memory_order_relaxed))
+			return true;
 	}
+
+	if(current == queue.Claim)
+		return true;
+
+	_IsParallelSolveAbandoned.store(true, std::memory_order_relaxed);
+	return false;
 }
 
+void
+Physics::PushEvent(IslandQueue& queue, const CollisionListEntry& collision)
+{
+	queue.Events.push_back({ collision, GetStateStamp(collision.A), GetStateStamp(collision.B) });
+	std::push_heap(queue.Events.begin(), queue.Events.end(), IsLater);
+}
 
-std::vector<Physics::ResolvedListEntry>
-Physics::ResolveUpdatedMovement(const float& deltaTime)
+bool
+Physics::IsStale(const SolverEvent& event) const
 {
-	std::vector<ResolvedListEntry> Resolved;
-
-	// Start with the earliest collision and resolve the new motion and add the entities that collided to a "dirty set".
-	std::sort(_CollisionList.begin(), _CollisionList.end());
-	for(auto& Collision : _CollisionList)
-		// God I really want std::set.contains()...
-		// "If dirtyList doesn't contain either A or B..
-		if(_DirtyList.find(Collision.A) == _DirtyList.end() &&
-			_DirtyList.find(Collision.B) == _DirtyList.end())
-		{
-			// Continue resolving collisions, but skip any that involve objects in the dirty set.
-			auto Moves = ResolveMove(deltaTime, Collision);
-			Resolved.push_back(Moves[0]);
-			Resolved.push_back(Moves[1]);
+	return event.StateA != GetStateStamp(event.Collision.A) || event.StateB != GetStateStamp(event.Collision.B);
+}
 
-			_DirtyList.insert(Collision.A);
-			_DirtyList.insert(Collision.B);
-		}
+bool
+Physics::IsLater(const SolverEvent& a, const SolverEvent& b)
+{
+	return IsEarlier(b.Collision, a.Collision);
+}
+
+bool
+Physics::IsEarlier(const CollisionListEntry& a, const CollisionListEntry& b)
+{
+	if(a.TimeOfCollision != b.TimeOfCollision)
+		return a.TimeOfCollision < b.TimeOfCollision;
+	if(a.A != b.A)
+		return a.A < b.A;
+	return a.B < b.B;
+}
 
-	return Resolved;
+uint32_t
+Physics::GetStateStamp(const Entity& entity) const
+{
+	const auto index = static_cast<size_t>(entity.Index());
+	return index < _ResolvedIndex.size() ? _ResolvedIndex[index] : 0;
 }
 
+void
+Physics::AddResolved(std::vector<ResolvedListEntry>& resolvedList, const ResolvedListEntry& resolved)
+{
+	const auto index = static_cast<size_t>(resolved.Entity.Index());
+	if(index >= _ResolvedIndex.size())
+		_ResolvedIndex.resize(index + 1, 0);
+
+	resolvedList.push_back(resolved);
+	_ResolvedIndex[index] = static_cast<uint32_t>(resolvedList.size());
+}
 
 std::array<Physics::ResolvedListEntry, 2>
-Physics::ResolveMove(const float& deltaTime, const CollisionListEntry collision) const
+Physics::ResolveMove(const IslandQueue& queue, const float& deltaTime, const CollisionListEntry collision) const
 {
 	// This is probably all kinds of wrong, but I have never studied physics
 	// so I'm just sort of making this up as I go along, helped with some
@@ -563,18 +684,15 @@ Physics::ResolveMove(const float& deltaTime, const CollisionListEntry collision)
 
 	// https://www.youtube.com/watch?v=Dww4ArU5JF8
 
-	const auto transA = _TransformManager.GetMutable(collision.A).value();
-	Rigidbody* rigidA;
-	_RigidbodyManager.GetMutable(collision.A, rigidA);
-
-	const auto transB = _TransformManager.GetMutable(collision.B).value();
-	Rigidbody* rigidB;
-	_RigidbodyManager.GetMutable(collision.B, rigidB);
+	// Either may already have bounced off something earlier in the frame.
+	const auto stateA = GetState(queue.Resolved, collision.A);
+	const auto stateB = GetState(queue.Resolved, collision.B);
 
-	const auto startPosA = transA->pos + rigidA->velocity * (collision.TimeOfCollision * deltaTime);
-	const auto startPosB = transB->pos + rigidB->velocity * (collision.TimeOfCollision * deltaTime);
+	const auto startPosA = stateA.Position + stateA.Velocity * ((collision.TimeOfCollision - stateA.Time) * deltaTime);
+	const auto startPosB = stateB.Position + stateB.Velocity * ((collision.TimeOfCollision - stateB.Time) * deltaTime);
 
-	auto relPos = startPosB - startPosA;
+	// They can be touching across an edge of the field.
+	auto relPos = WrapDelta(startPosB - startPosA);
 
 	// Split the problem into two parts: the component normal to the collision
 	// and the component tangential to the collision.
@@ -585,16 +703,16 @@ Physics::ResolveMove(const float& deltaTime, const CollisionListEntry collision)
 	// Conservation of Momentum (tangential)
 	// Dot(impactTangent, A.velocity) = Dot(impactTangent, endVelA);
 	// Dot(impactTangent, B.velocity) = Dot(impactTangent, endVelB);
-	const auto finalATangent = Dot(rigidA->velocity, impactTangent); // A.vel * cos(theta)
-	const auto finalBTangent = Dot(rigidB->velocity, impactTangent); // B.vel * cos(theta)
+	const auto finalATangent = Dot(stateA.Velocity, impactTangent); // A.vel * cos(theta)
+	const auto finalBTangent = Dot(stateB.Velocity, impactTangent); // B.vel * cos(theta)
 
 	// @NOTE: I am most likely mis-using this term here.
 	const float e = 0.95f; // Coefficient of restitution
 	// e = B.Velocity - A.Velocity / endVelB - endVelA
 
 	// Conservation of Momentum (normal)
-	const auto normalA = Dot(rigidA->velocity, impactNormal); // A.vel * sin(theta)
-	const auto normalB = Dot(rigidB->velocity, impactNormal); // B.vel * sin(theta)
+	const auto normalA = Dot(stateA.Velocity, impactNormal); // A.vel * sin(theta)
+	const auto normalB = Dot(stateB.Velocity, impactNormal); // B.vel * sin(theta)
 	// massA * normalA + massB * normalB = massA * finalANormal + massB * finalBNormal;
 
 	// Did the algebra and this is what fell out.
@@ -611,36 +729,91 @@ Physics::ResolveMove(const float& deltaTime, const CollisionListEntry collision)
 	// Enqueue the resolved entry.
 
 	ResolvedListEntry resolvedA;
-	resolvedA.AngularVelocity = rigidA->angularVelocity;
+	resolvedA.AngularVelocity = stateA.AngularVelocity;
 	resolvedA.Entity          = collision.A;
-	resolvedA.Position        = transA->pos + (rigidA->velocity * collision.TimeOfCollision * deltaTime);
+	resolvedA.Position        = startPosA;
 	resolvedA.Velocity        = (impactNormal * finalANormal) + (impactTangent * finalATangent);
 	resolvedA.Time            = collision.TimeOfCollision;
+	resolvedA.Type            = collision.EntityAType;
+	resolvedA.Other           = collision.B;
 
 	ResolvedListEntry resolvedB;
-	resolvedB.AngularVelocity = rigidB->angularVelocity;
+	resolvedB.AngularVelocity = stateB.AngularVelocity;
 	resolvedB.Entity          = collision.B;
-	resolvedB.Position        = transB->pos + (rigidB->velocity * collision.TimeOfCollision * deltaTime);
+	resolvedB.Position        = startPosB;
 	resolvedB.Velocity        = (impactNormal * finalBNormal) + (impactTangent * finalBTangent);
 	resolvedB.Time            = collision.TimeOfCollision;
+	resolvedB.Type            = collision.EntityBType;
+	resolvedB.Other           = collision.A;
 
 	return { resolvedA, resolvedB };
 }
 
+Physics::ResolvedListEntry
+Physics::GetState(const std::vector<ResolvedListEntry>& resolvedList, const Entity& entity) const
+{
+	const auto stamp = GetStateStamp(entity);
+	if(stamp != 0)
+		return resolvedList[stamp - 1];
+
+	const auto optionalRigidbody = _RigidbodyManager.Get(entity);
+	const auto optionalTrans     = _TransformManager.Get(entity);
+
+	ResolvedListEntry state;
+	state.Entity          = entity;
+	state.Position        = optionalTrans.value().pos;
+	state.Velocity        = optionalRigidbody.value().velocity;
+	state.AngularVelocity = optionalRigidbody.value().angularVelocity;
+	state.Type            = optionalRigidbody.value().colliderType;
+
+	return state;
+}
+
+double
+Physics::MillisecondsSince(const Clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+Vector2
+Physics::WrapDelta(const Vector2& delta) const
+{
+	return Vector2(delta.x - std::round(delta.x / _GameFieldDim.x) * _GameFieldDim.x,
+	               delta.y - std::round(delta.y / _GameFieldDim.y) * _GameFieldDim.y);
+}
+
 
 void
 Physics::FinalizeMoves(const float& deltaTime)
 {
-	// Step 9, create a new MoveList set that contains no duplicates.
-	std::unordered_set<MoveList::Entry> uniqueMoves;
-	for(auto& moveList : _MoveLists)
-		for(auto& move : moveList)
-			uniqueMoves.insert(move);
+	// Only a body's latest resolved state counts. Events are resolved in time order, so it's also the last in time.
+	const auto isLatest = [this](const size_t index)
+	{
+		return GetStateStamp(_ResolvedList[index].Entity) == index + 1;
+	};
+
+	// A body that hit something can end up anywhere its new course takes it, so tell the contact cache how far that
+	// was on top of its reach, before the transforms move.
+	for(size_t i = 0; i < _ResolvedList.size(); ++i)
+	{
+		const auto& entry = _ResolvedList[i];
+		if(!ContactCache::IsCacheable(entry.Type) || !isLatest(i))
+			continue;
 
+		const auto optStart = _TransformManager.Get(entry.Entity);
+		if(!optStart.has_value())
+			continue;
 
-	// Step 9.5.. Iterate MoveList and complete every move.
-	for(const auto& [rigidbody, position] : uniqueMoves)
+		const auto finalPos = entry.Position + (entry.Velocity * ((1.0f - entry.Time) * deltaTime));
+		_ContactCache.Moved(entry.Entity, WrapDelta(finalPos - optStart->pos).Length());
+	}
+
+	// Step 9. Iterate the enqueued moves and complete every one.
+	for(const auto& rigidbody : _Moves)
 	{
+		if(ContactCache::IsCacheable(rigidbody.colliderType))
+			_ContactCache.Moved(rigidbody.entity, rigidbody.velocity.Length() * deltaTime);
+
 		auto optTrans = _TransformManager.GetMutable(rigidbody.entity);
 		if(!optTrans.has_value())
 		{
@@ -658,9 +831,13 @@ Physics::FinalizeMoves(const float& deltaTime)
 	}
 
 	// Step 10 Iterate ResolvedList and stomp over with revised moves that are legal.
-	for(auto& entry : _ResolvedList)
+	for(size_t i = 0; i < _ResolvedList.size(); ++i)
 	{
-		auto [entity, position, velocity, angularVelocity, time] = entry;
+		if(!isLatest(i))
+			continue;
+
+		const auto& entry = _ResolvedList[i];
+		auto [entity, position, velocity, angularVelocity, time, type, other] = entry;
 
 		auto optTrans = _TransformManager.GetMutable(entity);
 		if(!optTrans.has_value())
@@ -691,10 +868,119 @@ Physics::FinalizeMoves(const float& deltaTime)
 }
 
 void
-Physics::DetectSecondaryCollisions(const std::vector<Physics::ResolvedListEntry> ResolvedThisIteration)
+Physics::DetectSecondaryCollisions(IslandQueue& queue, const size_t firstNew, const float& deltaTime)
 {
-	// Step 7. Check the NEW elements in resolved list against the full move list, looking for further collisions.
+	// Only the bodies that changed course are looked at, and only against what the broadphase filed near them, so
+	// this costs in proportion to the collisions rather than the scene.
+	for(auto i = firstNew; i < queue.Resolved.size(); ++i)
+	{
+		const auto resolved = queue.Resolved[i];
+		if(resolved.Time >= 1.0f)
+			continue;
+
+		// Where it's going for the rest of the frame. Neighbours were filed with bounds padded by their own movement.
+		const auto endPosition = resolved.Position + resolved.Velocity * ((1.0f - resolved.Time) * deltaTime);
+		const auto startAABB   = ColliderUtils::GetAABB(resolved.Type, resolved.Position);
+		const auto endAABB     = ColliderUtils::GetAABB(resolved.Type, endPosition);
+		const AABB sweptAABB(Vector2(std::min(startAABB.min.x, endAABB.min.x) - ENQUEUE_PADDING,
+		                             std::min(startAABB.min.y, endAABB.min.y) - ENQUEUE_PADDING),
+		                     Vector2(std::max(startAABB.max.x, endAABB.max.x) + ENQUEUE_PADDING,
+		                             std::max(startAABB.max.y, endAABB.max.y) + ENQUEUE_PADDING));
+
+		// A body can be filed in several cells or as several ghosts, but only needs testing once.
+		const auto query = ++_NearbyQuery;
+		auto& nearby     = queue.Nearby;
+		nearby.clear();
+		const auto gather = [&](const MoveList::Entry& entry)
+		{
+			if(!TryClaim(queue, entry.Entity))
+				return;
+
+			const auto index = static_cast<size_t>(entry.Entity.Index());
+			if(index >= _NearbyStamps.size())
+				_NearbyStamps.resize(index + 1, 0);
+
+			if(_NearbyStamps[index] == query)
+				return;
+
+			_NearbyStamps[index] = query;
+			nearby.push_back(entry);
+		};
+		// The grid hands back whole cells. Only bodies filed where the new path reaches can be hit, as the sweep and
+		// prune would have it, and claiming the rest would tie this queue to islands it never needed.
+		_Broadphase->ForEachNear(sweptAABB, [&](const MoveList::Entry& entry)
+		{
+			const auto position = resolved.Position + WrapDelta(entry.Pos - resolved.Position);
+			const auto bounds   = GetEnqueueBounds(entry.Type, position, entry.Velocity, deltaTime);
+			if(bounds.max.x >= sweptAABB.min.x && bounds.min.x <= sweptAABB.max.x &&
+			   bounds.max.y >= sweptAABB.min.y && bounds.min.y <= sweptAABB.max.y)
+				gather(entry);
+		});
+
+		// Bullets aren't in the broadphase. Any that could reach the new path are picked out by distance instead.
+		if(!ColliderUtils::IsBullet(resolved.Type))
+		{
+			const auto travel = resolved.Velocity.Length() * (1.0f - resolved.Time) * deltaTime +
+				ColliderUtils::GetRadiusFromType(resolved.Type) + ColliderUtils::Bullet;
+			for(const auto& projectile : _Projectiles)
+			{
+				const auto reach = travel + projectile.Velocity.Length() * deltaTime;
+				if(WrapDelta(projectile.Pos - resolved.Position).LengthSq() <= reach * reach)
+					gather(projectile);
+			}
+		}
+
+		// Another queue has something near here, so this will all be done again in one queue.
+		if(queue.Claim != 0 && _IsParallelSolveAbandoned.load(std::memory_order_relaxed))
+			return;
+
+		MoveList::Entry self;
+		self.Entity = resolved.Entity;
+		self.Type   = resolved.Type;
 
-	// @TODO:
-	//	Iterate ResolvedThisIteration
+		for(const auto& neighbour : nearby)
+		{
+			const auto entity = neighbour.Entity;
+			if(entity == resolved.Entity || entity == resolved.Other)
+				continue;
+
+			// A neighbour that's been resolved is somewhere else by now. If that was in this same event it gets its own
+			// turn in this loop, so only one of the two tests the pair.
+			auto state       = ResolvedListEntry();
+			const auto stamp = GetStateStamp(entity);
+			if(stamp != 0)
+			{
+				if(stamp > firstNew && !(resolved.Entity < entity))
+					continue;
+				state = queue.Resolved[stamp - 1];
+			}
+			else
+			{
+				state.Position = neighbour.Pos;
+				state.Velocity = neighbour.Velocity;
+			}
+
+			// Bring both up to whichever was resolved later, and the neighbour round to the near side of the field.
+			const auto startTime = std::max(resolved.Time, state.Time);
+			if(startTime >= 1.0f)
+				continue;
+
+			self.Pos      = resolved.Position + resolved.Velocity * ((startTime - resolved.Time) * deltaTime);
+			self.Velocity = resolved.Velocity;
+
+			auto other     = neighbour;
+			other.Velocity = state.Velocity;
+			other.Pos      = self.Pos + WrapDelta(state.Position + state.Velocity * ((startTime - state.Time) * deltaTime) - self.Pos);
+
+			// The narrowphase measures time from startTime to the end of the frame, so map it back.
+			queue.SecondaryCollisions.clear();
+			_Narrowphase.TestPair(self, other, (1.0f - startTime) * deltaTime, queue.SecondaryCollisions);
+			++queue.SecondaryPairsTested;
+			for(auto collision : queue.SecondaryCollisions)
+			{
+				collision.TimeOfCollision = startTime + collision.TimeOfCollision * (1.0f - startTime);
+				PushEvent(queue, collision);
+			}
+		}
+	}
 }
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
 #include <vector>
-#include <set>
-#include <future>
 
 #include "../Math/AABB.h"
 
@@ -10,49 +12,59 @@
 #include "../ECS/Transform.h"
 #include "../ECS/Rigidbody.h"
 
+#include "Broadphase.h"
 #include "ColliderType.h"
+#include "CollisionListEntry.h"
+#include "ContactCache.h"
+#include "GridBroadphase.h"
 #include "MoveList.h"
+#include "Narrowphase.h"
+#include "PhysicsStats.h"
+#include "SpatialQueries.h"
 
 class Circle;
+class ThreadPool;
 class TransformManager;
 class RigidbodyManager;
 
 class Physics
 {
 public:
-	Physics(TransformManager& transformManager, RigidbodyManager& rigidbodyManager, const Vector2& gameFieldDim);
+	Physics(TransformManager& transformManager,
+	        RigidbodyManager& rigidbodyManager,
+	        ThreadPool& workers,
+	        const Vector2& gameFieldDim,
+	        BroadphaseType broadphaseType = BroadphaseType::GRID,
+	        const PhysicsGridSettings& gridSettings = PhysicsGridSettings());
+
+	BroadphaseType GetBroadphaseType() const { return _BroadphaseType; }
+
+	// The most collisions resolved in one Simulate. Anything past it is reported but left to pass through.
+	void SetEventBudget(uint32_t eventBudget) { _EventBudget = eventBudget; }
+	uint32_t GetEventBudget() const { return _EventBudget; }
+
+	const PhysicsSolverCounters& GetSolverCounters() const { return _SolverCounters; }
+
+	// Only the sweep and prune broadphase tests pairs one at a time, so on the grid these stay at zero.
+	const ContactCacheCounters& GetContactCacheCounters() const { return _ContactCache.GetCounters(); }
+
+	// Timings and counts for every stage of the last Simulate, the counters above included.
+	const PhysicsFrameStats& GetFrameStats() const { return _FrameStats; }
 
 	void Enqueue(const Rigidbody& rb, const float& deltaTime);
+	void Enqueue(const Rigidbody& rb, const Transform& rbTrans, const float& deltaTime);
 
 	void Simulate(const float& deltaTime);
 
 	void EndFrame();
 
-	//@NOTE @IMPORTANT: This method is written to be as fast as possible. NOT as ACCURATE as possible!
-	bool IsOverlappingAnything(const Circle& testCircle, ColliderType ignore = ColliderType::NONE);
+	// Whether anything but `ignore` overlaps the circle, tested exactly. Only meaningful between Simulate and EndFrame.
+	bool IsOverlappingAnything(const Circle& testCircle, ColliderType ignore = ColliderType::NONE) const;
 
-	struct CollisionListEntry
-	{
-		Entity A;
-		Entity B;
-		ColliderType EntityAType;
-		ColliderType EntityBType;
-		float MassA;
-		float MassB;
-		float TimeOfCollision;
-
-		bool operator<(const CollisionListEntry& other) const
-		{
-			return (this->TimeOfCollision < other.TimeOfCollision);
-		}
-
-		bool operator==(const CollisionListEntry& other) const
-		{
-			return A == other.A &&
-				B == other.B &&
-				fabs(TimeOfCollision - other.TimeOfCollision) < FLT_EPSILON;
-		}
-	};
+	// Overlaps, casts and nearest neighbours against this frame's bodies. Only meaningful between Simulate and EndFrame.
+	const SpatialQueries& GetQueries() const { return _Queries; }
+
+	using CollisionListEntry = ::CollisionListEntry;
 
 	const std::vector<CollisionListEntry>& GetCollisionReport() const
 	{
@@ -60,7 +72,9 @@ public:
 	};
 
 private:
+	using Clock = std::chrono::steady_clock;
 
+	// Where a body is at Time, through the frame, and how it moves from there.
 	struct ResolvedListEntry
 	{
 		Entity Entity;
@@ -68,110 +82,227 @@ private:
 		Vector2 Velocity;
 		float AngularVelocity = 0;
 		float Time            = 0;
+		ColliderType Type     = ColliderType::NONE;
+
+		// Who it was resolved against, already moving apart, so isn't tested again.
+		::Entity Other;
 	};
 
 
-	// Utility
-	struct TileRange
+	// Physics Pipeline
+
+	// A predicted collision, and which of each body's resolved states it was predicted from.
+	struct SolverEvent
 	{
-		int_fast8_t MinTileX;
-		int_fast8_t MinTileY;
-		int_fast8_t MaxTileX;
-		int_fast8_t MaxTileY;
+		CollisionListEntry Collision;
+		uint32_t StateA;
+		uint32_t StateB;
 	};
-	TileRange GetTileRange(const AABB& aabb) const;
 
+	// The events of one or more islands of colliding bodies, resolved in time order on one worker, and what they
+	// resolved to. A frame without enough collisions to share out puts them all in one of these. Kept a cache line
+	// apart, as they're counted into from different workers.
+	struct alignas(64) IslandQueue
+	{
+		// A min-heap on time of collision, by IsLater.
+		std::vector<SolverEvent> Events;
 
-	// Physics Pipeline
+		// A body's stamp in _ResolvedIndex points in here, for the queue that owns the body.
+		std::vector<ResolvedListEntry> Resolved;
+
+		// Events taken off the queue that were still valid, in the order they came off.
+		std::vector<CollisionListEntry> Report;
 
-	std::vector<CollisionListEntry> DetectInitialCollisions(MoveList& moveList, const float& deltaTime) const;
+		PhysicsSolverCounters Counters;
+		uint32_t Iterations           = 0;
+		uint64_t SecondaryPairsTested = 0;
 
-	void RemoveDuplicateCollisions();
+		// What this queue claims bodies as while queues run side by side. Zero when it's running alone.
+		uint32_t Claim = 0;
 
-	void DetectSecondaryCollisions(std::vector<ResolvedListEntry> resolvedThisIteration);
+		// Scratch for DetectSecondaryCollisions.
+		std::vector<MoveList::Entry> Nearby;
+		std::vector<CollisionListEntry> SecondaryCollisions;
+	};
 
-	std::vector<ResolvedListEntry> ResolveUpdatedMovement(const float& deltaTime);
+	// Tests the entries in the queue's resolved list from `firstNew` on against their neighbours in the broadphase, and
+	// queues what they'll hit.
+	void DetectSecondaryCollisions(IslandQueue& queue, size_t firstNew, const float& deltaTime);
 
-	std::array<ResolvedListEntry, 2> ResolveMove(const float& deltaTime, CollisionListEntry collision) const;
+	// Casts bullets [first, last) of _Projectiles through the broadphase.
+	void CastProjectiles(size_t first, size_t last, float deltaTime);
 
-	void FinalizeMoves(const float& deltaTime);
+	// Resolves this frame's collisions, side by side on the pool when BuildIslandQueues made more than one queue.
+	void ResolveEvents(size_t queueCount, const float& deltaTime);
+
+	// Works through one queue in time order until it's empty, the budget runs out, or, running side by side, it reaches
+	// a body another queue has.
+	void ResolveQueue(IslandQueue& queue, const float& deltaTime);
+
+	// Groups the collision list into islands that share no bodies, and the islands into queues of at least
+	// RESOLVE_BATCH collisions. Returns how many queues there are.
+	size_t BuildIslandQueues();
+	uint32_t FindIsland(uint32_t index);
+
+	// Puts the whole collision list in the first queue, to be resolved on one thread.
+	void BuildSingleQueue();
+	IslandQueue& OpenQueue(size_t index);
+
+	// Runs the queues from BuildIslandQueues side by side and merges what they resolved, in the order one queue would
+	// have resolved it. Returns false, having undone everything, if any two queues reached the same body or between
+	// them went over the budget.
+	bool ResolveIslandsInParallel(size_t queueCount, const float& deltaTime);
+
+	// Whether the queue may look at or change the body. Running side by side, that's only if no other queue has, and
+	// if one has, every queue is stopped.
+	bool TryClaim(IslandQueue& queue, const Entity& entity);
 
+	void PushEvent(IslandQueue& queue, const CollisionListEntry& collision);
+	bool IsStale(const SolverEvent& event) const;
 
-	// OBB Collisions
+	// Earliest first, ties broken by the pair, so the order never depends on which worker found what.
+	static bool IsLater(const SolverEvent& a, const SolverEvent& b);
+	static bool IsEarlier(const CollisionListEntry& a, const CollisionListEntry& b);
+
+	// Where an entity's latest entry in its resolved list is, plus one. Zero if it hasn't hit anything yet.
+	uint32_t GetStateStamp(const Entity& entity) const;
+	void AddResolved(std::vector<ResolvedListEntry>& resolvedList, const ResolvedListEntry& resolved);
+
+	std::array<ResolvedListEntry, 2> ResolveMove(const IslandQueue& queue,
+	                                             const float& deltaTime,
+	                                             CollisionListEntry collision) const;
+
+	// The latest state resolved for a body this frame, or where it started the frame if it hasn't hit anything.
+	ResolvedListEntry GetState(const std::vector<ResolvedListEntry>& resolvedList, const Entity& entity) const;
+
+	// The shortest way round the field from one point to another.
+	Vector2 WrapDelta(const Vector2& delta) const;
+
+	// A body's AABB padded by its movement this frame, as it's filed in the broadphase.
+	static AABB GetEnqueueBounds(const ColliderType& type,
+	                             const Vector2& position,
+	                             const Vector2& velocity,
+	                             float deltaTime);
+
+	void FinalizeMoves(const float& deltaTime);
 
-	void ShipVsAsteroid(const MoveList::ColliderRanges& ranges, std::vector<CollisionListEntry>& collisions) const;
-	static void OBBVsSpecificAsteroid(const OBB& ship,
-	                                  const Rigidbody& shipRigidbody,
-	                                  const std::vector<MoveList::Entry>::iterator asteroidBegin,
-	                                  const std::vector<MoveList::Entry>::iterator asteroidEnd,
-	                                  const float& asteroidRadius,
-	                                  std::vector<CollisionListEntry>& collisions);
+	static double MillisecondsSince(Clock::time_point start);
 
+	static std::unique_ptr<Broadphase> MakeBroadphase(BroadphaseType broadphaseType,
+	                                                  const Narrowphase& narrowphase,
+	                                                  ContactCache& contactCache,
+	                                                  ThreadPool& workers,
+	                                                  const Vector2& gameFieldDim,
+	                                                  const PhysicsGridSettings& gridSettings);
 
-	// Circle Collisions
 
-	static void BulletVsAsteroid(const MoveList::ColliderRanges& ranges,
-	                             std::vector<CollisionListEntry>& collisions,
-	                             const float& deltaTime);
-	static void AsteroidVsAsteroid(const MoveList::ColliderRanges& ranges,
-	                               std::vector<CollisionListEntry>& collisions,
-	                               const float& deltaTime);
+	static constexpr uint32_t DEFAULT_EVENT_BUDGET = 4096;
 
-	static void CircleVsCircles(const MoveList::Entry& Circle,
-	                            const float& CircleRadius,
-	                            const float& CircleMass,
-	                            std::vector<MoveList::Entry>::iterator CirclesBegin,
-	                            std::vector<MoveList::Entry>::iterator CirclesEnd,
-	                            const float& CirclesMass,
-	                            const float& RadiusPlusRadiusSquared,
-	                            const float& DeltaTime,
-	                            const ColliderType& TypeA,
-	                            const ColliderType& TypeB,
-	                            std::vector<CollisionListEntry>& Collisions);
+	// Bullets cast per pool task.
+	static constexpr size_t PROJECTILE_BATCH = 64;
 
-	static float GetMassFromColliderType(const ColliderType& type);
+	// Islands are handed to the pool in queues of at least this many collisions.
+	static constexpr size_t RESOLVE_BATCH = 64;
 
-	static const int MAX_SOLVER_ITERATIONS = 3;
-	inline static const float ASTEROID_MASSES[] { 16.0f, 4.0f, 1.0f };
+	// How long to hold off solving side by side after it couldn't be.
+	static constexpr uint32_t SERIAL_SOLVE_FRAMES = 30;
 
 	TransformManager& _TransformManager;
 	RigidbodyManager& _RigidbodyManager;
+	ThreadPool& _Workers;
 
 	const Vector2& _GameFieldDim;
 
-	static const int CHUNKS_X    = 8;
-	static const int CHUNKS_Y    = 8;
-	static const int CHUNK_COUNT = CHUNKS_X * CHUNKS_Y;
+	// Every body's AABB is padded by its movement this frame plus this much before it goes to the broadphase.
+	static constexpr float ENQUEUE_PADDING = 15.0f;
 
-	const float _ChunkSizeX;
-	const float _ChunkSizeY;
+	const BroadphaseType _BroadphaseType;
 
-	// The entrypoint for the physics system. Entries are enqueued into a MoveList when they
-	// request a move from the system during the frame.
-	std::array<MoveList, CHUNK_COUNT> _MoveLists;
+	Narrowphase _Narrowphase;
 
-	// Workers responsible for DetectInitialCollisions
-	std::array<std::future<std::vector<CollisionListEntry>>, CHUNK_COUNT> _Workers;
+	// Asteroid pairs known to be too far apart to meet for a while.
+	ContactCache _ContactCache;
 
-	// Result from DetectInitialCollisions
+	std::unique_ptr<Broadphase> _Broadphase;
+
+	// Every body enqueued this frame, once each, to be moved by FinalizeMoves.
+	std::vector<Rigidbody> _Moves;
+
+	// Bullets enqueued this frame. They're small and fast, so rather than being filed in the broadphase they're cast
+	// through it.
+	std::vector<MoveList::Entry> _Projectiles;
+
+	SpatialQueries _Queries;
+
+	// Output of the broadphase, one list per pool worker so they never share.
+	std::vector<std::vector<CollisionListEntry>> _WorkerCollisions;
+
+	// Scratch for CastProjectiles, per pool worker, kept apart so workers counting don't fight over a cache line.
+	struct alignas(64) ProjectileScratch
+	{
+		std::vector<CollisionListEntry> Hits;
+		uint64_t PairsTested = 0;
+	};
+	std::vector<ProjectileScratch> _WorkerProjectiles;
+
+	// Every worker's collisions merged.
 	std::vector<CollisionListEntry> _CollisionList;
 
+	// Grown to the most queues a frame has used, and reused.
+	std::vector<IslandQueue> _IslandQueues;
+
+	// Union-find parents by entity index. Only the bodies in this frame's collisions are set.
+	std::vector<uint32_t> _IslandParent;
+
+	// By entity index of an island's root, which queue it went to.
+	std::vector<uint32_t> _IslandQueueIds;
+
+	// By entity index, which queue has looked at the body while queues run side by side. Anything below _ClaimBase
+	// is left from an earlier frame, so unclaimed.
+	std::unique_ptr<std::atomic<uint32_t>[]> _Claims;
+	size_t _ClaimsSize;
+	uint32_t _ClaimBase;
+
+	// Set by the first queue to reach another's body, or go over the budget, to stop the rest.
+	std::atomic<bool> _IsParallelSolveAbandoned;
+	std::atomic<uint32_t> _ParallelEventsProcessed;
+
+	// Frames left to solve in one queue, since the last had queues reach each other or ran out of budget. The next
+	// would most likely do the same, and be thrown away.
+	uint32_t _SerialSolveFrames;
+
+	// The next collision each queue resolved side by side, as a heap on time of collision, for merging them back in
+	// the order one queue would have taken them.
+	struct MergeHead
+	{
+		uint32_t Queue;
+		uint32_t Index;
+	};
+	std::vector<MergeHead> _MergeHeads;
+
+	uint32_t _EventBudget;
+	PhysicsSolverCounters _SolverCounters;
+
+	PhysicsFrameStats _FrameStats;
+
+	// When the frame's first body was enqueued.
+	Clock::time_point _EnqueueStart;
+
+	// Each pool worker's busy time as DetectCollisions started.
+	std::vector<uint64_t> _WorkerBusyAtDetect;
+
 	// A list of all collisions that took place so that gameplay code can react.
 	std::vector<CollisionListEntry> _CollisionReport;
 
 	std::vector<ResolvedListEntry> _ResolvedList;
 
-	std::set<Entity> _DirtyList;
-};
-
+	// By entity index, one past where its latest entry in _ResolvedList is, or in its queue's list while they're being
+	// resolved. Zero if it has none.
+	std::vector<uint32_t> _ResolvedIndex;
 
-namespace std
-{
-template <> struct hash<Physics::CollisionListEntry>
-{
-	inline size_t operator()(const Physics::CollisionListEntry& entry) const noexcept
-	{
-		return entry.A.Hash() ^ entry.B.Hash();
-	}
+	// For DetectSecondaryCollisions. A body has been gathered for a query if its stamp matches, and queries are
+	// numbered across every queue.
+	std::vector<uint32_t> _NearbyStamps;
+	std::atomic<uint32_t> _NearbyQuery;
 };
-}
+
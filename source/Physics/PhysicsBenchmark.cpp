@@ -0,0 +1,155 @@
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "PhysicsBenchmark.h"
+#include "Physics.h"
+
+#include "../ECS/BodyArchetype.h"
+#include "../ECS/EntityManager.h"
+#include "../ECS/RigidbodyManager.h"
+#include "../ECS/TransformManager.h"
+#include "../State/Timer.h"
+
+namespace
+{
+constexpr std::array<size_t, 4> BODY_COUNTS = { 1000, 2500, 5000, 10000 };
+
+// Field area per body. The field grows with the count so the density, and the collisions per body, stay put.
+constexpr float AREA_PER_BODY = 100.0f * 100.0f;
+
+constexpr float MAX_SPEED  = 200.0f;
+constexpr float DELTA_TIME = 1.0f / 60.0f;
+
+// Frames to settle the first frame's overlaps, then frames measured.
+constexpr int WARMUP_FRAMES   = 10;
+constexpr int MEASURED_FRAMES = 120;
+
+struct Result
+{
+	double ResolveMs  = 0.0;
+	double FinalizeMs = 0.0;
+	uint64_t Events   = 0;
+	uint64_t Bodies   = 0;
+};
+
+// Two medium asteroids 3 apart and closing at 10 a frame, the first 10 in from the left edge, on a grid of one cell.
+// The first one's bounds hang off the edge, so the cell holds it both where it is and a field over, and only the
+// copy where it is can hit the second one.
+bool IsWrappedPairFound(ThreadPool& workers)
+{
+	constexpr float FIELD_SIDE = 2500.0f;
+	constexpr float SPEED      = 300.0f;
+
+	const auto fieldDim = Vector2::One() * FIELD_SIDE;
+
+	Timer time;
+	EntityManager entities(time);
+	BodyArchetype bodies;
+	TransformManager transforms(bodies, 2);
+	RigidbodyManager rigidbodies(bodies, 2);
+	Physics physics(transforms, rigidbodies, workers, fieldDim, BroadphaseType::GRID, { 1, 1 });
+
+	std::vector<Entity> created;
+	entities.CreateBatch(2, created);
+
+	std::array<Transform, 2> bodyTransforms {};
+	bodyTransforms[0].pos = Vector2(10.0f, FIELD_SIDE / 2.0f);
+	bodyTransforms[1].pos = Vector2(10.0f + 2.0f * ColliderUtils::Medium + 3.0f, FIELD_SIDE / 2.0f);
+
+	std::array<Rigidbody, 2> bodyRigidbodies {};
+	for(size_t i = 0; i < bodyRigidbodies.size(); ++i)
+	{
+		bodyRigidbodies[i].entity          = created[i];
+		bodyRigidbodies[i].colliderType    = ColliderType::MEDIUM_ASTEROID;
+		bodyRigidbodies[i].velocity        = Vector2(i == 0 ? SPEED : -SPEED, 0.0f);
+		bodyRigidbodies[i].angularVelocity = 0.0f;
+	}
+	transforms.AddBatch(created.data(), bodyTransforms.data(), created.size());
+	rigidbodies.AddBatch(bodyRigidbodies.data(), bodyRigidbodies.size());
+
+	rigidbodies.EnqueueAll(physics, DELTA_TIME);
+	physics.Simulate(DELTA_TIME);
+	const auto isFound = physics.GetCollisionReport().size() == 1;
+	physics.EndFrame();
+	return isFound;
+}
+
+Result Measure(ThreadPool& workers, const size_t count)
+{
+	const auto fieldSide = std::sqrt(static_cast<float>(count) * AREA_PER_BODY);
+	const auto fieldDim  = Vector2::One() * fieldSide;
+
+	Timer time;
+	EntityManager entities(time);
+	BodyArchetype bodies;
+	TransformManager transforms(bodies, static_cast<int>(count));
+	RigidbodyManager rigidbodies(bodies, static_cast<int>(count));
+	Physics physics(transforms, rigidbodies, workers, fieldDim);
+
+	// Kept in the rigidbody manager rather than the body archetype, so every resolve goes through its lookup.
+	std::vector<Entity> created;
+	entities.CreateBatch(count, created);
+
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> position(0.0f, fieldSide);
+	std::uniform_real_distribution<float> velocity(-MAX_SPEED, MAX_SPEED);
+
+	std::vector<Transform> bodyTransforms(created.size());
+	std::vector<Rigidbody> bodyRigidbodies(created.size());
+	for(size_t i = 0; i < created.size(); ++i)
+	{
+		bodyTransforms[i].pos = Vector2(position(random), position(random));
+
+		auto& rb           = bodyRigidbodies[i];
+		rb.entity          = created[i];
+		rb.colliderType    = ColliderType::MEDIUM_ASTEROID;
+		rb.velocity        = Vector2(velocity(random), velocity(random));
+		rb.angularVelocity = 0.0f;
+	}
+	transforms.AddBatch(created.data(), bodyTransforms.data(), created.size());
+	rigidbodies.AddBatch(bodyRigidbodies.data(), bodyRigidbodies.size());
+
+	Result result;
+	for(auto frame = 0; frame < WARMUP_FRAMES + MEASURED_FRAMES; ++frame)
+	{
+		rigidbodies.EnqueueAll(physics, DELTA_TIME);
+		physics.Simulate(DELTA_TIME);
+
+		if(frame >= WARMUP_FRAMES)
+		{
+			const auto& stats = physics.GetFrameStats();
+			result.ResolveMs += stats.ResolveEventsMs;
+			result.FinalizeMs += stats.FinalizeMovesMs;
+			result.Events += stats.Solver.EventsProcessed;
+			result.Bodies += stats.Bodies;
+		}
+
+		physics.EndFrame();
+	}
+	return result;
+}
+}
+
+void
+PhysicsBenchmark::Run(ThreadPool& workers)
+{
+	std::cout << "Physics resolve benchmark, " << MEASURED_FRAMES << " frames each:\n";
+	std::cout << "  Pair across the edge of a 1x1 grid: " << (IsWrappedPairFound(workers) ? "found" : "MISSED!") << "\n";
+
+	for(const auto count : BODY_COUNTS)
+	{
+		const auto result = Measure(workers, count);
+
+		const auto nsPer = [](const double ms, const uint64_t per)
+		{
+			return per > 0 ? ms * 1e6 / static_cast<double>(per) : 0.0;
+		};
+
+		std::cout << "  " << count << " rigidbodies, " << result.Events / MEASURED_FRAMES << " events per frame:"
+			<< "   Resolve " << nsPer(result.ResolveMs, result.Events) << " ns per event."
+			<< "   Finalize " << nsPer(result.FinalizeMs, result.Bodies) << " ns per body.\n";
+	}
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+class ThreadPool;
+
+// Debug benchmark for collision resolution, toggled from the debug keys. Steps a private copy of the physics over
+// 1k to 10k rigidbodies at the same density, so each body meets about as many others whatever the count, and prints
+// what resolving costs per event and finalizing costs per body. Both should stay flat as the count grows. First checks
+// that a grid of one cell still finds a pair across its edge. Blocks until it's done.
+namespace PhysicsBenchmark
+{
+void Run(ThreadPool& workers);
+}
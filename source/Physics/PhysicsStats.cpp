@@ -0,0 +1,43 @@
+#include "PhysicsStats.h"
+
+void
+PhysicsFrameStats::WriteCsvHeader(std::ostream& stream) const
+{
+	stream << "Frame,EnqueueMs,DetectCollisionsMs";
+	for(size_t i = 0; i < DetectCollisionsWorkerMs.size(); ++i)
+		stream << ",DetectCollisionsWorker" << i << "Ms";
+
+	stream << ",CastProjectilesMs,MergeCollisionsMs,ResolveEventsMs,FinalizeMovesMs,SimulateMs"
+		<< ",Bodies,Projectiles,PairsTested,ProjectilePairsTested,SecondaryPairsTested"
+		<< ",Hits,Collisions,SolverIterations"
+		<< ",EventsProcessed,StaleEvents,EventsDropped,BudgetExhaustions,IslandQueues,IslandRetries"
+		<< ",ContactCacheHits,ContactCacheMisses,ContactCacheEvictions";
+
+	// Named for the fewest bodies a bucket's cells hold.
+	for(size_t i = 0; i < CellOccupancy.size(); ++i)
+		stream << ",CellsWith" << (i == 0 ? 0 : static_cast<size_t>(1) << (i - 1));
+
+	stream << "\n";
+}
+
+void
+PhysicsFrameStats::WriteCsvRow(std::ostream& stream) const
+{
+	stream << Frame << "," << EnqueueMs << "," << DetectCollisionsMs;
+	for(const auto workerMs : DetectCollisionsWorkerMs)
+		stream << "," << workerMs;
+
+	stream << "," << CastProjectilesMs << "," << MergeCollisionsMs << "," << ResolveEventsMs << "," << FinalizeMovesMs
+		<< "," << SimulateMs
+		<< "," << Bodies << "," << Projectiles << "," << PairsTested << "," << ProjectilePairsTested
+		<< "," << SecondaryPairsTested
+		<< "," << Hits << "," << Collisions << "," << SolverIterations
+		<< "," << Solver.EventsProcessed << "," << Solver.StaleEvents << "," << Solver.EventsDropped
+		<< "," << Solver.BudgetExhaustions << "," << Solver.IslandQueues << "," << Solver.IslandRetries
+		<< "," << ContactCache.Hits << "," << ContactCache.Misses << "," << ContactCache.Evictions;
+
+	for(const auto cells : CellOccupancy)
+		stream << "," << cells;
+
+	stream << "\n";
+}
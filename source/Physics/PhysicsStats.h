@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "Broadphase.h"
+#include "ContactCache.h"
+
+// What the solver got through. All but BudgetExhaustions are for the last Simulate.
+struct PhysicsSolverCounters
+{
+	// Collisions resolved.
+	uint32_t EventsProcessed = 0;
+
+	// Predicted for a body that had changed course by the time they came up, so thrown away.
+	uint32_t StaleEvents = 0;
+
+	// Still valid when the budget ran out. Reported, but never resolved.
+	uint32_t EventsDropped = 0;
+
+	// Frames since startup that ran out of budget.
+	uint32_t BudgetExhaustions = 0;
+
+	// Island queues resolved side by side on the pool. Zero if it was all resolved on one thread.
+	uint32_t IslandQueues = 0;
+
+	// Frames since startup whose island queues reached each other's bodies, or went over the budget between them,
+	// so were resolved again on one thread.
+	uint32_t IslandRetries = 0;
+};
+
+// Where the last frame's physics time went, and how much work each stage did. Filled in by Simulate, and times are
+// in milliseconds.
+struct PhysicsFrameStats
+{
+	// Simulate calls since startup.
+	uint64_t Frame = 0;
+
+	// From the frame's first Enqueue to Simulate, which is filing every body in the broadphase.
+	double EnqueueMs = 0.0;
+
+	// The broadphase and narrowphase over every filed body, and how long each pool worker spent on it.
+	double DetectCollisionsMs = 0.0;
+	std::vector<double> DetectCollisionsWorkerMs;
+
+	// Bullets cast through the broadphase.
+	double CastProjectilesMs = 0.0;
+
+	// Every worker's collisions merged and grouped into the solver's island queues.
+	double MergeCollisionsMs = 0.0;
+
+	// The solver working through the queues, predicting again for whatever changed course.
+	double ResolveEventsMs = 0.0;
+
+	double FinalizeMovesMs = 0.0;
+
+	// All of Simulate, so everything above but EnqueueMs.
+	double SimulateMs = 0.0;
+
+	uint32_t Bodies      = 0;
+	uint32_t Projectiles = 0;
+
+	// Pairs handed to the narrowphase by the broadphase, by bullet casts, and by the solver predicting again.
+	uint64_t PairsTested           = 0;
+	uint64_t ProjectilePairsTested = 0;
+	uint64_t SecondaryPairsTested  = 0;
+
+	// Collisions found before the solver started, and reported in all.
+	uint32_t Hits       = 0;
+	uint32_t Collisions = 0;
+
+	// Events the solver took off the queue, stale ones included.
+	uint32_t SolverIterations = 0;
+
+	PhysicsSolverCounters Solver;
+	ContactCacheCounters ContactCache;
+
+	// As BroadphaseStats::CellOccupancy.
+	std::array<uint32_t, BroadphaseStats::OCCUPANCY_BUCKETS> CellOccupancy = {};
+
+	// A CSV header line, and a row for this frame. There's a column per pool worker, so rows only line up with a
+	// header written from the same Physics.
+	void WriteCsvHeader(std::ostream& stream) const;
+	void WriteCsvRow(std::ostream& stream) const;
+};
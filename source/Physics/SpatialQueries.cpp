@@ -0,0 +1,313 @@
+#include <cmath>
+
+#include "SpatialQueries.h"
+#include "Broadphase.h"
+#include "CollisionTests.h"
+
+#include "../ECS/TransformManager.h"
+
+#include "../Math/AABB.h"
+#include "../Math/OBB.h"
+
+SpatialQueries::SpatialQueries(const Broadphase& broadphase,
+                               const std::vector<MoveList::Entry>& projectiles,
+                               const TransformManager& transformManager,
+                               ThreadPool& workers,
+                               const Vector2& gameFieldDim)
+	: _Broadphase(broadphase),
+	  _Projectiles(projectiles),
+	  _TransformManager(transformManager),
+	  _Workers(workers),
+	  _GameFieldDim(gameFieldDim)
+{
+}
+
+bool
+SpatialQueries::IsOverlappingAnything(const Circle& circle, const QueryFilter filter) const
+{
+	std::vector<Body> bodies;
+	Gather(AABB(circle.Center - Vector2(circle.Radius, circle.Radius), circle.Center + Vector2(circle.Radius, circle.Radius)),
+	       filter,
+	       bodies);
+
+	return std::any_of(bodies.begin(), bodies.end(), [&](const Body& body)
+	{
+		return Overlaps(body, circle);
+	});
+}
+
+void
+SpatialQueries::OverlapCircle(const Circle& circle, std::vector<QueryHit>& hits, const QueryFilter filter) const
+{
+	hits.clear();
+
+	std::vector<Body> bodies;
+	Gather(AABB(circle.Center - Vector2(circle.Radius, circle.Radius), circle.Center + Vector2(circle.Radius, circle.Radius)),
+	       filter,
+	       bodies);
+
+	for(const auto& body : bodies)
+	{
+		if(!Overlaps(body, circle))
+			continue;
+
+		const auto position = circle.Center + WrapDelta(body.Position - circle.Center);
+		hits.push_back({ body.Entity, body.Type, position, (position - circle.Center).Length() });
+	}
+
+	std::sort(hits.begin(), hits.end(), [](const QueryHit& a, const QueryHit& b)
+	{
+		return a.Distance < b.Distance || (a.Distance == b.Distance && a.Entity < b.Entity);
+	});
+}
+
+void
+SpatialQueries::OverlapCircleBatch(const std::vector<Circle>& circles,
+                                   std::vector<std::vector<QueryHit>>& hits,
+                                   const QueryFilter filter) const
+{
+	RunBatch(circles, hits, [&](const Circle& circle, std::vector<QueryHit>& result)
+	{
+		OverlapCircle(circle, result, filter);
+	});
+}
+
+std::optional<QueryHit>
+SpatialQueries::Raycast(const QueryRay& ray, const QueryFilter filter) const
+{
+	return CircleCast(ray, 0.0f, filter);
+}
+
+void
+SpatialQueries::RaycastBatch(const std::vector<QueryRay>& rays,
+                             std::vector<std::optional<QueryHit>>& hits,
+                             const QueryFilter filter) const
+{
+	RunBatch(rays, hits, [&](const QueryRay& ray, std::optional<QueryHit>& result)
+	{
+		result = Raycast(ray, filter);
+	});
+}
+
+std::optional<QueryHit>
+SpatialQueries::CircleCast(const QueryRay& ray, const float radius, const QueryFilter filter) const
+{
+	// Any longer and the far end could reach round to bodies behind the start.
+	const auto length = std::min(ray.MaxDistance, std::min(_GameFieldDim.x, _GameFieldDim.y));
+	const auto motion = ray.Direction * length;
+	const auto end    = ray.Origin + motion;
+
+	std::vector<Body> bodies;
+	if(radius <= ColliderUtils::Bullet)
+	{
+		GatherAlongSegment(ray.Origin, end, filter, bodies);
+	}
+	else
+	{
+		Gather(AABB(Vector2(std::min(ray.Origin.x, end.x) - radius, std::min(ray.Origin.y, end.y) - radius),
+		            Vector2(std::max(ray.Origin.x, end.x) + radius, std::max(ray.Origin.y, end.y) + radius)),
+		       filter,
+		       bodies);
+	}
+
+	std::optional<QueryHit> nearest;
+	auto nearestTime = FLT_MAX;
+	for(const auto& body : bodies)
+	{
+		// The segment is no longer than the field, so one of the copies around the one nearest the start is the
+		// first it reaches.
+		const auto nearestCopy = ray.Origin + WrapDelta(body.Position - ray.Origin);
+		for(auto y = -1; y <= 1; ++y)
+		{
+			for(auto x = -1; x <= 1; ++x)
+			{
+				auto copy     = body;
+				copy.Position = nearestCopy + Vector2(x * _GameFieldDim.x, y * _GameFieldDim.y);
+
+				float time;
+				if(!Cast(copy, ray.Origin, motion, radius, time))
+					continue;
+
+				if(!nearest.has_value() || time < nearestTime || (time == nearestTime && body.Entity < nearest->Entity))
+				{
+					nearestTime = time;
+					nearest     = QueryHit { body.Entity, body.Type, copy.Position, time * length };
+				}
+			}
+		}
+	}
+
+	return nearest;
+}
+
+void
+SpatialQueries::CircleCastBatch(const std::vector<QueryRay>& rays,
+                                const float radius,
+                                std::vector<std::optional<QueryHit>>& hits,
+                                const QueryFilter filter) const
+{
+	RunBatch(rays, hits, [&](const QueryRay& ray, std::optional<QueryHit>& result)
+	{
+		result = CircleCast(ray, radius, filter);
+	});
+}
+
+void
+SpatialQueries::Nearest(const Vector2& point,
+                        const size_t count,
+                        std::vector<QueryHit>& hits,
+                        const QueryFilter filter,
+                        const float maxDistance) const
+{
+	hits.clear();
+	if(count == 0)
+		return;
+
+	// Nothing is further than half the diagonal away, going the short way round.
+	const auto limit = std::min(maxDistance, (_GameFieldDim * 0.5f).Length());
+
+	std::vector<Body> bodies;
+	auto reach = std::min(NEAREST_START_REACH, limit);
+	while(true)
+	{
+		bodies.clear();
+		hits.clear();
+		Gather(AABB(point - Vector2(reach, reach), point + Vector2(reach, reach)), filter, bodies);
+
+		// Only what's within reach counts. Anything past it could be further than something in a corner of the box
+		// we haven't looked in.
+		for(const auto& body : bodies)
+		{
+			const auto position = point + WrapDelta(body.Position - point);
+			const auto distance = (position - point).Length();
+			if(distance <= reach)
+				hits.push_back({ body.Entity, body.Type, position, distance });
+		}
+
+		if(hits.size() >= count || reach >= limit)
+			break;
+
+		reach = std::min(reach * 2.0f, limit);
+	}
+
+	const auto closer = [](const QueryHit& a, const QueryHit& b)
+	{
+		return a.Distance < b.Distance || (a.Distance == b.Distance && a.Entity < b.Entity);
+	};
+
+	const auto kept = std::min(count, hits.size());
+	std::partial_sort(hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>(kept), hits.end(), closer);
+	hits.resize(kept);
+}
+
+void
+SpatialQueries::NearestBatch(const std::vector<Vector2>& points,
+                             const size_t count,
+                             std::vector<std::vector<QueryHit>>& hits,
+                             const QueryFilter filter,
+                             const float maxDistance) const
+{
+	RunBatch(points, hits, [&](const Vector2& point, std::vector<QueryHit>& result)
+	{
+		Nearest(point, count, result, filter, maxDistance);
+	});
+}
+
+void
+SpatialQueries::Gather(const AABB& bounds, const QueryFilter filter, std::vector<Body>& bodies) const
+{
+	// A body's bounds were padded by its movement when it was filed, so wherever it ended up, it's still inside them.
+	_Broadphase.ForEachNear(bounds, [&](const MoveList::Entry& entry)
+	{
+		if(filter.Accepts(entry.Type))
+			bodies.push_back({ entry.Entity, entry.Type, entry.Pos, 0.0f });
+	});
+
+	// Bullets aren't filed, but there are few enough of them to look at every one.
+	for(const auto& projectile : _Projectiles)
+	{
+		if(filter.Accepts(projectile.Type))
+			bodies.push_back({ projectile.Entity, projectile.Type, projectile.Pos, 0.0f });
+	}
+
+	Deduplicate(bodies);
+}
+
+void
+SpatialQueries::GatherAlongSegment(const Vector2& start,
+                                   const Vector2& end,
+                                   const QueryFilter filter,
+                                   std::vector<Body>& bodies) const
+{
+	_Broadphase.ForEachAlongSegment(start, end, [&](const MoveList::Entry& entry)
+	{
+		if(filter.Accepts(entry.Type))
+			bodies.push_back({ entry.Entity, entry.Type, entry.Pos, 0.0f });
+	});
+
+	for(const auto& projectile : _Projectiles)
+	{
+		if(filter.Accepts(projectile.Type))
+			bodies.push_back({ projectile.Entity, projectile.Type, projectile.Pos, 0.0f });
+	}
+
+	Deduplicate(bodies);
+}
+
+void
+SpatialQueries::Deduplicate(std::vector<Body>& bodies) const
+{
+	std::sort(bodies.begin(), bodies.end(), [](const Body& a, const Body& b)
+	{
+		return a.Entity < b.Entity;
+	});
+	bodies.erase(std::unique(bodies.begin(), bodies.end(), [](const Body& a, const Body& b)
+	{
+		return a.Entity == b.Entity;
+	}), bodies.end());
+
+	// The broadphase only knows where they started the frame. Anything destroyed since can't be hit.
+	auto kept = bodies.begin();
+	for(auto& body : bodies)
+	{
+		const auto transform = _TransformManager.Get(body.Entity);
+		if(!transform.has_value())
+			continue;
+
+		body.Position = transform->pos;
+		body.Rotation = transform->rot;
+		*kept++       = body;
+	}
+	bodies.erase(kept, bodies.end());
+}
+
+bool
+SpatialQueries::Overlaps(const Body& body, const Circle& circle) const
+{
+	const auto position = circle.Center + WrapDelta(body.Position - circle.Center);
+
+	if(ColliderUtils::IsPlayerShip(body.Type))
+		return CollisionTests::OBBToCircle(OBB(position, ColliderUtils::GetDimFromType(body.Type) * 0.5f, body.Rotation), circle);
+
+	return CollisionTests::CircleToCircle(Circle(position, ColliderUtils::GetRadiusFromType(body.Type)), circle);
+}
+
+bool
+SpatialQueries::Cast(const Body& body, const Vector2& start, const Vector2& motion, const float radius, float& time) const
+{
+	if(ColliderUtils::IsPlayerShip(body.Type))
+	{
+		const OBB box(body.Position, ColliderUtils::GetDimFromType(body.Type) * 0.5f, body.Rotation);
+		return CollisionTests::SweptOBBToCircle(box, Vector2::Zero(), Circle(start, radius), motion, 1.0f, time);
+	}
+
+	const Circle grown(body.Position, ColliderUtils::GetRadiusFromType(body.Type) + radius);
+	return CollisionTests::SegmentToCircle(start, motion, grown, time);
+}
+
+Vector2
+SpatialQueries::WrapDelta(const Vector2& delta) const
+{
+	return Vector2(delta.x - _GameFieldDim.x * std::round(delta.x / _GameFieldDim.x),
+	               delta.y - _GameFieldDim.y * std::round(delta.y / _GameFieldDim.y));
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "../ECS/Entity.h"
+
+#include "../Math/Circle.h"
+#include "../Math/Vector2.h"
+
+#include "../Platform/ThreadPool.h"
+
+#include "ColliderType.h"
+#include "MoveList.h"
+
+class AABB;
+class Broadphase;
+class TransformManager;
+
+// Which collider types a query can hit.
+struct QueryFilter
+{
+	uint32_t Mask = UINT32_MAX;
+
+	bool Accepts(const ColliderType type) const
+	{
+		return (Mask & (1u << static_cast<uint32_t>(type))) != 0;
+	}
+
+	static QueryFilter Excluding(const ColliderType type)
+	{
+		return { UINT32_MAX & ~(1u << static_cast<uint32_t>(type)) };
+	}
+
+	static QueryFilter Asteroids()
+	{
+		return { (1u << static_cast<uint32_t>(ColliderType::LARGE_ASTEROID)) |
+			(1u << static_cast<uint32_t>(ColliderType::MEDIUM_ASTEROID)) |
+			(1u << static_cast<uint32_t>(ColliderType::SMOL_ASTEROID)) };
+	}
+};
+
+struct QueryHit
+{
+	Entity Entity;
+	ColliderType Type;
+
+	// Whichever copy of the body is nearest the query, so it can be off the field.
+	Vector2 Position;
+
+	// From the query's centre to the body's for overlaps and nearest, and along the ray for casts.
+	float Distance;
+};
+
+struct QueryRay
+{
+	Vector2 Origin;
+	Vector2 Direction; // Normalized.
+	float MaxDistance;
+};
+
+// Questions about what's where, answered from what was filed in the broadphase this frame, plus the bullets, which
+// aren't. Bodies are tested exactly, where they are now, and across the wrapped edges of the field. Only meaningful
+// between Physics::Simulate and Physics::EndFrame.
+//
+// Every query has a Batch form that takes an array and shares it out over the pool.
+class SpatialQueries
+{
+public:
+	SpatialQueries(const Broadphase& broadphase,
+	               const std::vector<MoveList::Entry>& projectiles,
+	               const TransformManager& transformManager,
+	               ThreadPool& workers,
+	               const Vector2& gameFieldDim);
+
+	// Stops at the first thing it finds.
+	bool IsOverlappingAnything(const Circle& circle, QueryFilter filter = {}) const;
+
+	// Everything overlapping the circle, nearest first.
+	void OverlapCircle(const Circle& circle, std::vector<QueryHit>& hits, QueryFilter filter = {}) const;
+	void OverlapCircleBatch(const std::vector<Circle>& circles,
+	                        std::vector<std::vector<QueryHit>>& hits,
+	                        QueryFilter filter = {}) const;
+
+	// The first body along the ray. Rays are cut short at the field's size, so nothing can be hit from both sides.
+	std::optional<QueryHit> Raycast(const QueryRay& ray, QueryFilter filter = {}) const;
+	void RaycastBatch(const std::vector<QueryRay>& rays,
+	                  std::vector<std::optional<QueryHit>>& hits,
+	                  QueryFilter filter = {}) const;
+
+	// As Raycast, for a circle of `radius` swept along the ray.
+	std::optional<QueryHit> CircleCast(const QueryRay& ray, float radius, QueryFilter filter = {}) const;
+	void CircleCastBatch(const std::vector<QueryRay>& rays,
+	                     float radius,
+	                     std::vector<std::optional<QueryHit>>& hits,
+	                     QueryFilter filter = {}) const;
+
+	// Up to `count` bodies whose centres are within `maxDistance` of `point`, nearest first.
+	void Nearest(const Vector2& point,
+	             size_t count,
+	             std::vector<QueryHit>& hits,
+	             QueryFilter filter = {},
+	             float maxDistance = FLT_MAX) const;
+	void NearestBatch(const std::vector<Vector2>& points,
+	                  size_t count,
+	                  std::vector<std::vector<QueryHit>>& hits,
+	                  QueryFilter filter = {},
+	                  float maxDistance = FLT_MAX) const;
+
+private:
+	// A body that might answer a query, where it is now.
+	struct Body
+	{
+		::Entity Entity;
+		ColliderType Type;
+		Vector2 Position;
+		float Rotation;
+	};
+
+	// Every body that passes the filter and might be inside `bounds`, once each.
+	void Gather(const AABB& bounds, QueryFilter filter, std::vector<Body>& bodies) const;
+
+	// The same, for the bodies a thin cast along the segment could reach.
+	void GatherAlongSegment(const Vector2& start, const Vector2& end, QueryFilter filter, std::vector<Body>& bodies) const;
+
+	void Deduplicate(std::vector<Body>& bodies) const;
+
+	bool Overlaps(const Body& body, const Circle& circle) const;
+
+	// Where along the segment a circle of `radius` swept from `start` first touches the body.
+	bool Cast(const Body& body, const Vector2& start, const Vector2& motion, float radius, float& time) const;
+
+	// The shortest way round the field from one point to another.
+	Vector2 WrapDelta(const Vector2& delta) const;
+
+	// Runs `run(query, result)` for each query, shared out over the pool in batches.
+	template <typename Query, typename Result, typename Run>
+	void RunBatch(const std::vector<Query>& queries, std::vector<Result>& results, const Run& run) const
+	{
+		results.resize(queries.size());
+
+		const auto batch = [&](const size_t first, const size_t last)
+		{
+			for(auto i = first; i < last; ++i)
+				run(queries[i], results[i]);
+		};
+
+		for(size_t first = 0; first < queries.size(); first += QUERY_BATCH)
+		{
+			const auto last = std::min(first + QUERY_BATCH, queries.size());
+			_Workers.Submit([&batch, first, last] { batch(first, last); });
+		}
+		_Workers.Wait();
+	}
+
+	// Queries run per pool task.
+	static constexpr size_t QUERY_BATCH = 16;
+
+	// Where Nearest starts looking, doubling until it's found enough.
+	static constexpr float NEAREST_START_REACH = 256.0f;
+
+	const Broadphase& _Broadphase;
+	const std::vector<MoveList::Entry>& _Projectiles;
+	const TransformManager& _TransformManager;
+	ThreadPool& _Workers;
+
+	const Vector2& _GameFieldDim;
+};
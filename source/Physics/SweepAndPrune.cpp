@@ -0,0 +1,281 @@
+#include <algorithm>
+
+#include "SweepAndPrune.h"
+#include "ContactCache.h"
+#include "Narrowphase.h"
+
+#include "../Platform/ThreadPool.h"
+
+SweepAndPrune::SweepAndPrune(const Narrowphase& narrowphase,
+                             ContactCache& contactCache,
+                             ThreadPool& workers,
+                             const Vector2& gameFieldDim)
+	: _Narrowphase(narrowphase),
+	  _ContactCache(contactCache),
+	  _Workers(workers),
+	  _GameFieldDim(gameFieldDim),
+	  _Frame(1),
+	  _WidestProxy(0.0f),
+	  _WorkerScratch(workers.WorkerCount()),
+	  _Collisions(nullptr)
+{
+}
+
+void
+SweepAndPrune::Insert(const MoveList::Entry& entry, const AABB& bounds)
+{
+	// Bodies never span the field, so each axis needs at most one ghost.
+	auto shiftX = 0.0f;
+	if(bounds.min.x < 0.0f)
+		shiftX = _GameFieldDim.x;
+	else if(bounds.max.x > _GameFieldDim.x)
+		shiftX = -_GameFieldDim.x;
+
+	auto shiftY = 0.0f;
+	if(bounds.min.y < 0.0f)
+		shiftY = _GameFieldDim.y;
+	else if(bounds.max.y > _GameFieldDim.y)
+		shiftY = -_GameFieldDim.y;
+
+	const auto key = static_cast<uint32_t>(entry.Entity.Index()) * GHOSTS;
+	AddProxy(entry, bounds, Vector2(0.0f, 0.0f), key);
+	if(shiftX != 0.0f)
+		AddProxy(entry, bounds, Vector2(shiftX, 0.0f), key + 1);
+	if(shiftY != 0.0f)
+		AddProxy(entry, bounds, Vector2(0.0f, shiftY), key + 2);
+	if(shiftX != 0.0f && shiftY != 0.0f)
+		AddProxy(entry, bounds, Vector2(shiftX, shiftY), key + 3);
+}
+
+void
+SweepAndPrune::AddProxy(const MoveList::Entry& entry, const AABB& bounds, const Vector2& shift, const uint32_t key)
+{
+	Proxy proxy;
+	proxy.MinX  = bounds.min.x + shift.x;
+	proxy.MaxX  = bounds.max.x + shift.x;
+	proxy.MinY  = bounds.min.y + shift.y;
+	proxy.MaxY  = bounds.max.y + shift.y;
+	proxy.Entry = static_cast<uint32_t>(_Entries.size());
+	proxy.Key   = key;
+
+	// Decided from which way the copy was shifted rather than its shifted bounds, so rounding at the edge can't leave
+	// a pair with no owner. Only a body starting off the near edge gets a copy shifted forward.
+	proxy.Owns = 0;
+	if(shift.x > 0.0f || (shift.x == 0.0f && bounds.min.x >= 0.0f))
+		proxy.Owns |= OWNS_X;
+	if(shift.y > 0.0f || (shift.y == 0.0f && bounds.min.y >= 0.0f))
+		proxy.Owns |= OWNS_Y;
+
+	_Entries.push_back(entry);
+	_Entries.back().Pos += shift;
+
+	// Back into the slot it sorted to last frame, if it had one. Claiming it means a body filed twice can't
+	// overwrite itself.
+	if(key < _Placements.size() && _Placements[key].Frame == _Frame - 1)
+	{
+		_Proxies[_Placements[key].Slot] = proxy;
+		_Placements[key].Frame          = 0;
+	}
+	else
+	{
+		_Fresh.push_back(proxy);
+	}
+}
+
+void
+SweepAndPrune::SortProxies()
+{
+	const auto byMinX = [](const Proxy& a, const Proxy& b)
+	{
+		return a.MinX < b.MinX;
+	};
+
+	_Proxies.erase(std::remove_if(_Proxies.begin(), _Proxies.end(), [](const Proxy& proxy)
+	{
+		return proxy.Key == NO_PROXY;
+	}), _Proxies.end());
+
+	// Bodies only move a little each frame, so last frame's order is nearly right and this is close to linear.
+	for(size_t i = 1; i < _Proxies.size(); ++i)
+	{
+		const auto proxy = _Proxies[i];
+		auto j           = i;
+		while(j > 0 && proxy.MinX < _Proxies[j - 1].MinX)
+		{
+			_Proxies[j] = _Proxies[j - 1];
+			--j;
+		}
+		_Proxies[j] = proxy;
+	}
+
+	// Newcomers have no history to exploit. Sort them on their own and merge them in, rather than having the
+	// insertion sort drag each one the whole length of the array.
+	// Merged into a spare array kept between frames, as std::inplace_merge allocates a buffer every time.
+	if(!_Fresh.empty())
+	{
+		std::sort(_Fresh.begin(), _Fresh.end(), byMinX);
+		_Merged.resize(_Proxies.size() + _Fresh.size());
+		std::merge(_Proxies.begin(), _Proxies.end(), _Fresh.begin(), _Fresh.end(), _Merged.begin(), byMinX);
+		_Proxies.swap(_Merged);
+		_Fresh.clear();
+	}
+
+	_WidestProxy = 0.0f;
+	for(size_t i = 0; i < _Proxies.size(); ++i)
+	{
+		const auto& proxy = _Proxies[i];
+		if(proxy.Key >= _Placements.size())
+			_Placements.resize(static_cast<size_t>(proxy.Key) + GHOSTS);
+
+		_Placements[proxy.Key] = { _Frame, static_cast<uint32_t>(i) };
+		_WidestProxy           = std::max(_WidestProxy, proxy.MaxX - proxy.MinX);
+	}
+}
+
+void
+SweepAndPrune::DetectCollisions(const float deltaTime, std::vector<std::vector<CollisionListEntry>>& collisions)
+{
+	SortProxies();
+
+	_Collisions = &collisions;
+	_Stats      = BroadphaseStats();
+	for(auto& scratch : _WorkerScratch)
+		scratch.PairsTested = 0;
+
+	for(size_t first = 0; first < _Proxies.size(); first += SWEEP_BATCH)
+	{
+		const auto last = std::min(first + SWEEP_BATCH, _Proxies.size());
+		_Workers.Submit([this, first, last, deltaTime] { SweepRange(first, last, deltaTime); });
+	}
+	_Workers.Wait();
+
+	for(const auto& scratch : _WorkerScratch)
+		_Stats.PairsTested += scratch.PairsTested;
+
+	_Collisions = nullptr;
+}
+
+void
+SweepAndPrune::SweepRange(const size_t first, const size_t last, const float deltaTime)
+{
+	const auto worker = _Workers.CurrentWorker();
+	auto& collisions  = (*_Collisions)[worker];
+	auto& scratch     = _WorkerScratch[worker];
+	auto& overlaps    = scratch.Overlaps;
+	const auto count  = _Proxies.size();
+
+	for(auto i = first; i < last; ++i)
+	{
+		const auto& a = _Proxies[i];
+
+		// Everything that starts before we end overlaps us on x. The first one that doesn't ends the sweep.
+		auto end = i + 1;
+		while(end < count && _Proxies[end].MinX <= a.MaxX)
+			++end;
+
+		// Whether they overlap on y as well is close to a coin toss, so gather without branching and only then test.
+		overlaps.resize(end - i);
+		size_t found = 0;
+		for(auto j = i + 1; j < end; ++j)
+		{
+			const auto& b   = _Proxies[j];
+			overlaps[found] = static_cast<uint32_t>(j);
+			found += (b.MinY <= a.MaxY) & (b.MaxY >= a.MinY);
+		}
+
+		for(size_t k = 0; k < found; ++k)
+		{
+			// Sorted, so b never starts before a on x.
+			const auto& b = _Proxies[overlaps[k]];
+			if((b.Owns & OWNS_X) == 0 || ((b.MinY > a.MinY ? b.Owns : a.Owns) & OWNS_Y) == 0)
+				continue;
+
+			const auto& entryA   = _Entries[a.Entry];
+			const auto& entryB   = _Entries[b.Entry];
+			const auto cacheable = ContactCache::IsCacheable(entryA.Type, entryB.Type);
+			if(cacheable && _ContactCache.CanSkip(entryA.Entity, entryB.Entity, worker))
+				continue;
+
+			const auto reported = collisions.size();
+			_Narrowphase.TestPair(entryA, entryB, deltaTime, collisions);
+			++scratch.PairsTested;
+
+			if(cacheable && collisions.size() == reported)
+			{
+				const auto separation = (entryB.Pos - entryA.Pos).Length() -
+					ColliderUtils::GetRadiusFromType(entryA.Type) -
+					ColliderUtils::GetRadiusFromType(entryB.Type);
+				_ContactCache.Record(entryA.Entity, entryB.Entity, separation, worker);
+			}
+		}
+	}
+}
+
+void
+SweepAndPrune::ForEachNear(const AABB& bounds, const Visitor visit) const
+{
+	// Ghosts only cover bodies whose own bounds cross an edge, so a query hanging off one is run again from the far
+	// side as well.
+	float shiftsX[2] = { 0.0f, 0.0f };
+	auto countX      = 1;
+	if(bounds.min.x < 0.0f)
+		shiftsX[countX++] = _GameFieldDim.x;
+	else if(bounds.max.x > _GameFieldDim.x)
+		shiftsX[countX++] = -_GameFieldDim.x;
+
+	float shiftsY[2] = { 0.0f, 0.0f };
+	auto countY      = 1;
+	if(bounds.min.y < 0.0f)
+		shiftsY[countY++] = _GameFieldDim.y;
+	else if(bounds.max.y > _GameFieldDim.y)
+		shiftsY[countY++] = -_GameFieldDim.y;
+
+	for(auto y = 0; y < countY; ++y)
+	{
+		for(auto x = 0; x < countX; ++x)
+		{
+			const Vector2 shift(shiftsX[x], shiftsY[y]);
+			ForEachNearAt(AABB(bounds.min + shift, bounds.max + shift), visit);
+		}
+	}
+}
+
+void
+SweepAndPrune::ForEachNearAt(const AABB& bounds, const Visitor visit) const
+{
+	const auto from = bounds.min.x - _WidestProxy;
+
+	auto proxy = std::lower_bound(_Proxies.begin(), _Proxies.end(), from, [](const Proxy& p, const float x)
+	{
+		return p.MinX < x;
+	});
+	for(; proxy != _Proxies.end() && proxy->MinX <= bounds.max.x; ++proxy)
+	{
+		if(proxy->MaxX >= bounds.min.x && proxy->MinY <= bounds.max.y && proxy->MaxY >= bounds.min.y)
+			visit(_Entries[proxy->Entry]);
+	}
+}
+
+void
+SweepAndPrune::ForEachAlongSegment(const Vector2& start,
+                                   const Vector2& end,
+                                   const Visitor visit) const
+{
+	// No cells to walk. Bullets only travel a few units a frame, so the segment's bounds are already tight.
+	ForEachNear(AABB(Vector2(std::min(start.x, end.x), std::min(start.y, end.y)),
+	                 Vector2(std::max(start.x, end.x), std::max(start.y, end.y))),
+	            visit);
+}
+
+void
+SweepAndPrune::EndFrame()
+{
+	// Keep the order for next frame, but empty every slot until its body is filed again.
+	for(auto& proxy : _Proxies)
+		proxy.Key = NO_PROXY;
+
+	_Entries.clear();
+	_Fresh.clear();
+
+	++_Frame;
+}
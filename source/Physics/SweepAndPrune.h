@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../Math/Vector2.h"
+
+#include "Broadphase.h"
+
+class ContactCache;
+class Narrowphase;
+class ThreadPool;
+
+// Sort and sweep on the x axis. Every body's padded bounds become a proxy in one array kept sorted by its left edge,
+// and a pair is only tested if the proxies overlap on both axes. The array keeps last frame's order, so the
+// insertion sort that fixes it up only has to move the proxies that overtook a neighbour.
+//
+// The field wraps, so a body whose bounds hang off an edge also gets a ghost proxy on the far side, shifted by the
+// field size, and up to three of them in a corner.
+//
+// Every pair is tested on its own, so pairs of asteroids the ContactCache knows can't meet yet are skipped.
+class SweepAndPrune final : public Broadphase
+{
+public:
+	SweepAndPrune(const Narrowphase& narrowphase,
+	              ContactCache& contactCache,
+	              ThreadPool& workers,
+	              const Vector2& gameFieldDim);
+
+	void Insert(const MoveList::Entry& entry, const AABB& bounds) override;
+	void DetectCollisions(float deltaTime, std::vector<std::vector<CollisionListEntry>>& collisions) override;
+	void ForEachNear(const AABB& bounds, Visitor visit) const override;
+	void ForEachAlongSegment(const Vector2& start,
+	                         const Vector2& end,
+	                         Visitor visit) const override;
+	const BroadphaseStats& GetStats() const override { return _Stats; }
+	void EndFrame() override;
+
+private:
+	struct Proxy
+	{
+		float MinX;
+		float MaxX;
+		float MinY;
+		float MaxY;
+
+		// Into _Entries, which holds the body at this proxy's shifted position.
+		uint32_t Entry;
+
+		// Entity index times GHOSTS plus which copy this is. Ties a proxy to its place in last frame's order.
+		uint32_t Key;
+
+		// OWNS_X and OWNS_Y, set where this copy's bounds start inside the field on that axis.
+		uint8_t Owns;
+	};
+
+	// Where a key's proxy ended up when it was last sorted.
+	struct Placement
+	{
+		uint32_t Frame = 0;
+		uint32_t Slot  = 0;
+	};
+
+	void AddProxy(const MoveList::Entry& entry, const AABB& bounds, const Vector2& shift, uint32_t key);
+
+	// Fills in the holes left by bodies that weren't filed again and gets the proxies back in order.
+	void SortProxies();
+
+	// Tests proxies [first, last) against everything after them that they overlap.
+	void SweepRange(size_t first, size_t last, float deltaTime);
+
+	void ForEachNearAt(const AABB& bounds, Visitor visit) const;
+
+	// The body itself, then copies shifted across x, y, and both.
+	static constexpr uint32_t GHOSTS = 4;
+
+	// Overlapping copies of a pair turn up once for every shift they share. Only the copy whose overlap starts inside
+	// the field is tested, which is decided by whichever of the two starts later on each axis.
+	static constexpr uint8_t OWNS_X = 1;
+	static constexpr uint8_t OWNS_Y = 2;
+
+	// Marks a slot in last frame's order that nobody has claimed this frame.
+	static constexpr uint32_t NO_PROXY = UINT32_MAX;
+
+	// Proxies swept per pool task.
+	static constexpr size_t SWEEP_BATCH = 1024;
+
+	const Narrowphase& _Narrowphase;
+	ContactCache& _ContactCache;
+	ThreadPool& _Workers;
+
+	const Vector2 _GameFieldDim;
+
+	std::vector<MoveList::Entry> _Entries;
+
+	// Sorted by MinX once SortProxies has run. Before that, last frame's order with this frame's proxies written
+	// over the slots their keys held.
+	std::vector<Proxy> _Proxies;
+
+	// Proxies with no slot from last frame, merged in by SortProxies.
+	std::vector<Proxy> _Fresh;
+
+	// What SortProxies merges into, then swaps with _Proxies.
+	std::vector<Proxy> _Merged;
+
+	// Indexed by Proxy::Key.
+	std::vector<Placement> _Placements;
+
+	uint32_t _Frame;
+
+	// The widest proxy in the sorted array, so a query knows how far left of itself to start looking.
+	float _WidestProxy;
+
+	// Per pool worker, and kept apart so workers don't fight over a cache line. Overlaps is scratch for SweepRange,
+	// kept so a sweep never allocates once it's grown.
+	struct alignas(64) WorkerScratch
+	{
+		std::vector<uint32_t> Overlaps;
+		uint64_t PairsTested = 0;
+	};
+	std::vector<WorkerScratch> _WorkerScratch;
+
+	BroadphaseStats _Stats;
+
+	// Where DetectCollisions is writing this frame.
+	std::vector<std::vector<CollisionListEntry>>* _Collisions;
+};
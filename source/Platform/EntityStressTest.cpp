@@ -0,0 +1,190 @@
+#include <algorithm>
+#include <iostream>
+
+#include "EntityStressTest.h"
+
+#include "../ECS/EntityManager.h"
+#include "../ECS/TransformManager.h"
+
+EntityStressTest::EntityStressTest(EntityManager& entities, TransformManager& transforms)
+	: _Entities(entities),
+	  _Transforms(transforms),
+	  _IsRunning(false),
+	  _Stage(0),
+	  _StageFrames(0),
+	  _MaxLive(0),
+	  _ChurnCursor(0)
+{
+}
+
+void
+EntityStressTest::Start()
+{
+	if(_IsRunning)
+		return;
+
+	std::cout << "Entity stress test started.\n";
+
+	_IsRunning   = true;
+	_Stage       = 0;
+	_StageFrames = 0;
+	_ChurnCursor = 0;
+	_Timings     = Timings();
+
+	// Churned entities aren't recycled until garbage collection, so leave room for a frame's worth on top.
+	const auto used = std::min<size_t>(_Entities.Count(), Entity::EID_MAX);
+	_MaxLive        = (Entity::EID_MAX - used) * CHURN_DIVISOR / (CHURN_DIVISOR + 1);
+}
+
+void
+EntityStressTest::Stop()
+{
+	if(!_IsRunning)
+		return;
+
+	_Entities.DestroyBatch(_Live.data(), _Live.size());
+	_Live.clear();
+	_IsRunning = false;
+
+	std::cout << "Entity stress test stopped.\n";
+}
+
+void
+EntityStressTest::Update()
+{
+	if(!_IsRunning)
+		return;
+
+	const auto target = StageSize(_Stage);
+	if(_Live.size() < target)
+	{
+		Spawn(std::min(target - _Live.size(), RAMP_PER_FRAME));
+		return;
+	}
+
+	Churn(target / CHURN_DIVISOR);
+	Measure();
+
+	if(++_StageFrames == FRAMES_PER_STAGE)
+	{
+		Report();
+		NextStage();
+	}
+}
+
+double
+EntityStressTest::SecondsSince(const Clock::time_point start)
+{
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void
+EntityStressTest::Spawn(const size_t count)
+{
+	_Batch.clear();
+
+	const auto start = Clock::now();
+	_Entities.CreateBatch(count, _Batch);
+
+	_BatchTransforms.resize(_Batch.size());
+	for(size_t i = 0; i < _Batch.size(); ++i)
+	{
+		_BatchTransforms[i].pos = Vector2(static_cast<float>(i % 2500), static_cast<float>(i / 2500));
+	}
+	_Transforms.AddBatch(_Batch.data(), _BatchTransforms.data(), _Batch.size());
+
+	_Timings.Create += SecondsSince(start);
+	_Timings.Created += _Batch.size();
+
+	_Live.insert(_Live.end(), _Batch.begin(), _Batch.end());
+}
+
+void
+EntityStressTest::Churn(const size_t count)
+{
+	// Kill the oldest slice and put fresh entities in their place, walking round the list frame by frame.
+	_Batch.clear();
+	for(size_t i = 0; i < count; ++i)
+	{
+		_Batch.push_back(_Live[(_ChurnCursor + i) % _Live.size()]);
+	}
+
+	const auto destroyStart = Clock::now();
+	_Entities.DestroyBatch(_Batch.data(), _Batch.size());
+	_Timings.Destroy += SecondsSince(destroyStart);
+	_Timings.Destroyed += _Batch.size();
+
+	//@NOTE: The destroyed slots aren't free until garbage collection, so these come from fresh or older slots.
+	_Batch.clear();
+	const auto createStart = Clock::now();
+	_Entities.CreateBatch(count, _Batch);
+
+	_BatchTransforms.resize(_Batch.size());
+	_Transforms.AddBatch(_Batch.data(), _BatchTransforms.data(), _Batch.size());
+	_Timings.Create += SecondsSince(createStart);
+	_Timings.Created += _Batch.size();
+
+	for(size_t i = 0; i < _Batch.size(); ++i)
+	{
+		_Live[(_ChurnCursor + i) % _Live.size()] = _Batch[i];
+	}
+	_ChurnCursor = (_ChurnCursor + count) % _Live.size();
+}
+
+void
+EntityStressTest::Measure()
+{
+	const auto existsStart = Clock::now();
+	size_t alive           = 0;
+	for(const auto& entity : _Live)
+	{
+		alive += _Entities.Exists(entity);
+	}
+	_Timings.Exists += SecondsSince(existsStart);
+	_Timings.Checked += _Live.size();
+
+	const auto iterateStart = Clock::now();
+	auto sum                = 0.0f;
+	for(const auto& transform : _Transforms)
+	{
+		sum += transform.pos.x;
+	}
+	_Timings.Iterate += SecondsSince(iterateStart);
+	_Timings.Iterated += _Transforms.Count();
+
+	// Keep the loops above from being optimised away.
+	if(alive > _Live.size() || sum < 0.0f)
+		std::cout << "";
+}
+
+void
+EntityStressTest::Report() const
+{
+	const auto nsPer = [](const double seconds, const size_t count)
+	{
+		return count > 0 ? seconds * 1e9 / static_cast<double>(count) : 0.0;
+	};
+
+	std::cout << "Entity stress test, " << _Live.size() << " live entities over " << FRAMES_PER_STAGE << " frames:"
+		<< "   Create " << nsPer(_Timings.Create, _Timings.Created) << " ns."
+		<< "   Destroy " << nsPer(_Timings.Destroy, _Timings.Destroyed) << " ns."
+		<< "   Exists " << nsPer(_Timings.Exists, _Timings.Checked) << " ns."
+		<< "   Iterate " << nsPer(_Timings.Iterate, _Timings.Iterated) << " ns per entity.\n";
+}
+
+size_t
+EntityStressTest::StageSize(const size_t stage) const
+{
+	return std::min(STAGES[stage], _MaxLive);
+}
+
+void
+EntityStressTest::NextStage()
+{
+	_StageFrames = 0;
+	_Timings     = Timings();
+
+	// Once the ID width stops the stages growing, stay on the last one and keep reporting it.
+	if(_Stage + 1 < STAGES.size() && StageSize(_Stage + 1) > StageSize(_Stage))
+		++_Stage;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include "../ECS/Entity.h"
+#include "../ECS/Transform.h"
+
+class EntityManager;
+class TransformManager;
+
+// Debug load test for the entity pipeline, toggled from the debug keys. It ramps the number of live entities through
+// each of STAGES in turn, churning a slice of them every frame, and prints what create, destroy, exists and
+// iteration cost per entity at each size. Stages are cut down to what the entity ID width leaves room for, and it
+// stops once they can't grow any more, so build with EUANITY_WIDE_ENTITIES to reach a million.
+class EntityStressTest
+{
+public:
+	EntityStressTest(EntityManager& entities, TransformManager& transforms);
+
+	bool IsRunning() const { return _IsRunning; }
+
+	void Start();
+	void Stop();
+
+	// Call once per frame, before garbage collection.
+	void Update();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr std::array<size_t, 4> STAGES = { 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024 };
+
+	// Entities added per frame while ramping up, so filling a stage doesn't stall for seconds.
+	static constexpr size_t RAMP_PER_FRAME = 64 * 1024;
+
+	// Once a stage is full, this fraction of it is destroyed and recreated every frame.
+	static constexpr size_t CHURN_DIVISOR = 100;
+
+	static constexpr int FRAMES_PER_STAGE = 300;
+
+	struct Timings
+	{
+		double Create  = 0.0;
+		double Destroy = 0.0;
+		double Exists  = 0.0;
+		double Iterate = 0.0;
+
+		size_t Created   = 0;
+		size_t Destroyed = 0;
+		size_t Checked   = 0;
+		size_t Iterated  = 0;
+	};
+
+	static double SecondsSince(Clock::time_point start);
+
+	void Spawn(size_t count);
+	void Churn(size_t count);
+	void Measure();
+	void Report() const;
+	size_t StageSize(size_t stage) const;
+	void NextStage();
+
+	EntityManager& _Entities;
+	TransformManager& _Transforms;
+
+	bool _IsRunning;
+	size_t _Stage;
+	int _StageFrames;
+
+	// The most entities the test can keep alive, set by Start from how many IDs the rest of the game left free.
+	size_t _MaxLive;
+
+	std::vector<Entity> _Live;
+	size_t _ChurnCursor;
+
+	// Scratch space, reused every frame.
+	std::vector<Entity> _Batch;
+	std::vector<Transform> _BatchTransforms;
+
+	Timings _Timings;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// A callable passed by reference, for callbacks that are only called before the function taking them returns. It
+// points at the caller's callable rather than copying it, so unlike std::function it never allocates, whatever the
+// callable captures. Never keep one past the call it was passed to.
+template <typename Signature> class FunctionRef;
+
+template <typename Return, typename... Args> class FunctionRef<Return(Args...)>
+{
+public:
+	// ReSharper disable once CppNonExplicitConvertingConstructor
+	template <typename Fn, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Fn>, FunctionRef>>>
+	FunctionRef(Fn&& fn)
+		: _Callable(const_cast<void*>(static_cast<const void*>(std::addressof(fn))))
+	{
+		using Callable = std::remove_reference_t<Fn>;
+		_Invoke        = [](void* callable, Args... args) -> Return
+		{
+			return (*static_cast<Callable*>(callable))(std::forward<Args>(args)...);
+		};
+	}
+
+	Return operator()(Args... args) const
+	{
+		return _Invoke(_Callable, std::forward<Args>(args)...);
+	}
+
+private:
+	void* _Callable;
+	Return (*_Invoke)(void*, Args...);
+};
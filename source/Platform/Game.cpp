@@ -1,10 +1,17 @@
 #include "Game.h"
 
+#include "../ECS/ArchetypeBenchmark.h"
 #include "../GameObject/Create.h"
 #include "../Math/EuanityMath.h"
 #include "../Physics/Physics.h"
-
-Game::Game(const std::string windowName, const int windowWidth, const int windowHeight, const Vector2& gameWorldDim)
+#include "../Physics/NarrowphaseBenchmark.h"
+#include "../Physics/PhysicsBenchmark.h"
+
+Game::Game(const std::string windowName,
+           const int windowWidth,
+           const int windowHeight,
+           const Vector2& gameWorldDim,
+           const BroadphaseType broadphaseType)
 	: IsDebugCamera(false),
 	  GameCam(this, windowWidth, windowHeight),
 	  DebugCam(this, windowWidth, windowHeight),
@@ -12,19 +19,28 @@ Game::Game(const std::string windowName, const int windowWidth, const int window
 	  RenderQueue(Renderer, GameCam, gameWorldDim),
 	  BackgroundRenderer({ windowWidth, windowHeight }),
 	  Input(InputHandler(_IsRunning)),
-	  Create(*this, Entities, Xforms, Sprites, Rigidbodies, UI, Time),
+	  Create(*this, Entities, Bodies, Xforms, Sprites, Rigidbodies, UI, Time),
 	  Entities(Time),
-	  Xforms(512),
-	  Sprites(Xforms, Entities, RenderQueue.GetSpriteAtlas(), 512),
+	  Bodies(1024),
+	  Xforms(Bodies, 512),
+	  Sprites(Xforms, Bodies, RenderQueue.GetSpriteAtlas(), 512),
 	  UI(Entities, Input.GetBuffer()),
-	  Physics(Xforms, Rigidbodies, gameWorldDim),
-	  Rigidbodies(Entities, 1024),
+	  StressTest(Entities, Xforms),
+	  Physics(Xforms, Rigidbodies, Workers, gameWorldDim, broadphaseType),
+	  Rigidbodies(Bodies, 1024),
 	  GameFieldDim(gameWorldDim),
 	  _IsRunning(true),
 	  _TimeFactor(1.0f)
 {
 	GameCam.SetFocalPoint(gameWorldDim * 0.5f);
 
+	// Everything that stores per-entity data hears about destroyed entities in one broadcast per frame.
+	Entities.RegisterStore(Xforms);
+	Entities.RegisterStore(Bodies);
+	Entities.RegisterStore(Rigidbodies);
+	Entities.RegisterStore(Sprites);
+	Entities.RegisterStore(UI);
+
 	const AABB debugCamView(-gameWorldDim*0.5f, gameWorldDim*1.5f);
 	DebugCam.SetCameraView(debugCamView);
 
@@ -68,6 +84,29 @@ Game::HandleDebugInput(const InputBuffer& inputBuffer)
 	{
 		_TimeFactor += 0.1f;
 	}
+
+	if(inputBuffer.Contains(InputOneShot::DEBUG_StressTest))
+	{
+		if(StressTest.IsRunning())
+			StressTest.Stop();
+		else
+			StressTest.Start();
+	}
+
+	if(inputBuffer.Contains(InputOneShot::DEBUG_NarrowphaseBenchmark))
+	{
+		NarrowphaseBenchmark::Run();
+	}
+
+	if(inputBuffer.Contains(InputOneShot::DEBUG_PhysicsBenchmark))
+	{
+		PhysicsBenchmark::Run(Workers);
+	}
+
+	if(inputBuffer.Contains(InputOneShot::DEBUG_ArchetypeBenchmark))
+	{
+		ArchetypeBenchmark::Run(Workers);
+	}
 }
 
 void
@@ -88,6 +127,9 @@ Game::Update(const float realDeltaTime)
 
 	Physics.EndFrame();
 
+	if(StressTest.IsRunning())
+		StressTest.Update();
+
 	GarbageCollection();
 
 	auto& cam = IsDebugCamera ? DebugCam : GameCam;
@@ -125,17 +167,16 @@ Game::Quit()
 void
 Game::GarbageCollection()
 {
-	// @TODO: This can be better.
-
-	Xforms.GarbageCollect(Entities);
-	UI.GarbageCollect();
+	// Registered stores are told about dead entities from in here.
 	Entities.GarbageCollect();
 }
 
 void
 Game::ResetAllSystems()
 {
+	StressTest.Stop();
 	Entities.Clear();
+	Bodies.Clear();
 	Xforms.Clear();
 	Rigidbodies.Clear();
 	UI.Clear();
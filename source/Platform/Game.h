@@ -6,6 +6,7 @@
 #include "../Renderer/RenderQueue.h"
 #include "../Renderer/BackgroundRenderer.h"
 
+#include "../ECS/BodyArchetype.h"
 #include "../ECS/EntityManager.h"
 #include "../ECS/TransformManager.h"
 #include "../ECS/SpriteManager.h"
@@ -16,6 +17,9 @@
 
 #include "../Physics/Physics.h"
 
+#include "EntityStressTest.h"
+#include "ThreadPool.h"
+
 #include "../Input/InputHandler.h"
 
 #include "../State/Timer.h"
@@ -26,7 +30,11 @@
 class Game
 {
 public:
-	Game(std::string windowName, int windowWidth, int windowHeight, const Vector2& gameWorldDim);
+	Game(std::string windowName,
+	     int windowWidth,
+	     int windowHeight,
+	     const Vector2& gameWorldDim,
+	     BroadphaseType broadphaseType = BroadphaseType::GRID);
 	Game() = delete;
 	Game(Game&) = delete;
 
@@ -85,11 +93,16 @@ public:
 
 	// ECS Systems
 	EntityManager Entities;
+	BodyArchetype Bodies;
 	TransformManager Xforms;
 	SpriteManager Sprites;
 	UIManager UI;
 
+	// Debug
+	EntityStressTest StressTest;
+
 	// Physics
+	ThreadPool Workers;
 	Physics Physics;
 	RigidbodyManager Rigidbodies;
 	const Vector2 GameFieldDim;
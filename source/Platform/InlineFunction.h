@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// A void() callable stored entirely inside the object, with no heap fallback. The callable must fit in Capacity
+// bytes and be trivially copyable, which covers lambdas capturing pointers, references and plain values. That
+// keeps InlineFunction itself trivially copyable, so containers can move it around with plain copies.
+template <size_t Capacity> class InlineFunction
+{
+public:
+	InlineFunction() = default;
+
+	// ReSharper disable once CppNonExplicitConvertingConstructor
+	template <typename Fn, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Fn>, InlineFunction>>>
+	InlineFunction(Fn&& fn)
+	{
+		using Callable = std::decay_t<Fn>;
+		static_assert(sizeof(Callable) <= Capacity, "Callable is too big for InlineFunction, capture less or bump Capacity.");
+		static_assert(alignof(Callable) <= alignof(std::max_align_t), "Callable is over-aligned for InlineFunction.");
+		static_assert(std::is_trivially_copyable_v<Callable> && std::is_trivially_destructible_v<Callable>,
+		              "InlineFunction only stores trivially copyable callables. Capture by pointer or reference instead.");
+
+		new(_Storage) Callable(std::forward<Fn>(fn));
+		_Invoke = [](void* storage) { (*static_cast<Callable*>(storage))(); };
+	}
+
+	void operator()()
+	{
+		_Invoke(_Storage);
+	}
+
+	explicit operator bool() const
+	{
+		return _Invoke != nullptr;
+	}
+
+private:
+	alignas(std::max_align_t) unsigned char _Storage[Capacity] {};
+	void (*_Invoke)(void*) = nullptr;
+};
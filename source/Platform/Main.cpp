@@ -1,4 +1,6 @@
+#include <fstream>
 #include <iostream>
+#include <string>
 
 //#include <vld.h>
 
@@ -6,8 +8,27 @@
 #include "FrameTimer.h"
 
 int
-main(int /*argc*/, char* /*args[]*/)
+main(int argc, char* args[])
 {
+	// Pass --broadphase=sap to swap the physics grid for sort and sweep, and --physics-csv=<path> to write out
+	// physics stats every frame.
+	const std::string physicsCsvArg = "--physics-csv=";
+
+	auto broadphaseType = BroadphaseType::GRID;
+	std::string physicsCsvPath;
+	for(auto i = 1; i < argc; ++i)
+	{
+		const std::string arg = args[i];
+		if(arg == "--broadphase=sap")
+			broadphaseType = BroadphaseType::SWEEP_AND_PRUNE;
+		else if(arg == "--broadphase=grid")
+			broadphaseType = BroadphaseType::GRID;
+		else if(arg.compare(0, physicsCsvArg.size(), physicsCsvArg) == 0)
+			physicsCsvPath = arg.substr(physicsCsvArg.size());
+		else
+			std::cout << "Ignoring unknown argument " << arg << "\n";
+	}
+
 	// Game Setup
 	const std::string windowName = "Just Asteroids";
 
@@ -15,7 +36,17 @@ main(int /*argc*/, char* /*args[]*/)
 	const auto screenHeight = 900;
 
 	const auto gameWorldDim = Vector2::One() * 2500.0f;
-	Game game(windowName, screenWidth, screenHeight, gameWorldDim);
+	Game game(windowName, screenWidth, screenHeight, gameWorldDim, broadphaseType);
+
+	std::ofstream physicsCsv;
+	if(!physicsCsvPath.empty())
+	{
+		physicsCsv.open(physicsCsvPath);
+		if(physicsCsv.is_open())
+			game.Physics.GetFrameStats().WriteCsvHeader(physicsCsv);
+		else
+			std::cout << "Couldn't open " << physicsCsvPath << " for physics stats\n";
+	}
 
 	// Frame Timer Setup
 	const auto updatesPerSecond = 60;
@@ -31,6 +62,9 @@ main(int /*argc*/, char* /*args[]*/)
 		game.Update(frameTime);
 		timer.UpdateEstimatedUpdateTime(updateBegin);
 
+		if(physicsCsv.is_open())
+			game.Physics.GetFrameStats().WriteCsvRow(physicsCsv);
+
 		// lock framerate
 		timer.Sleep(updateBegin);
 
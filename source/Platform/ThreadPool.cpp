@@ -0,0 +1,225 @@
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+namespace
+{
+// Which pool the current thread works for, and as which worker.
+thread_local const ThreadPool* t_Pool = nullptr;
+thread_local size_t t_WorkerIndex     = 0;
+}
+
+ThreadPool::ThreadPool(const size_t workerCount)
+	: _StatsStart(Clock::now())
+{
+	auto count = workerCount;
+	if(count == 0)
+		count = std::max(std::thread::hardware_concurrency(), 1u);
+
+	_Workers.reserve(count);
+	for(size_t i = 0; i < count; ++i)
+	{
+		_Workers.push_back(std::make_unique<Worker>());
+	}
+
+	// The last worker slot belongs to whoever calls Wait(), so it doesn't get a thread.
+	_Threads.reserve(count - 1);
+	for(size_t i = 0; i + 1 < count; ++i)
+	{
+		_Threads.emplace_back([this, i] { WorkerLoop(i); });
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> lock(_SleepMutex);
+		_IsStopping = true;
+	}
+	_WakeUp.notify_all();
+
+	for(auto& thread : _Threads)
+	{
+		thread.join();
+	}
+}
+
+void
+ThreadPool::Submit(const Task& task)
+{
+	// Split work stays with the worker that made it, where it's hot in cache. Everything else is dealt out.
+	size_t index;
+	if(t_Pool == this)
+	{
+		index = t_WorkerIndex;
+	}
+	else
+	{
+		index      = _NextDeque;
+		_NextDeque = (_NextDeque + 1) % _Workers.size();
+	}
+
+	_Unfinished.fetch_add(1, std::memory_order_relaxed);
+	{
+		auto& worker = *_Workers[index];
+		std::lock_guard<std::mutex> lock(worker.Mutex);
+		worker.Tasks.push_back(task);
+	}
+	_Queued.fetch_add(1, std::memory_order_release);
+
+	// Taking the lock stops a worker missing this between checking for work and going to sleep.
+	{
+		std::lock_guard<std::mutex> lock(_SleepMutex);
+	}
+	_WakeUp.notify_one();
+}
+
+void
+ThreadPool::Wait()
+{
+	const auto index = _Workers.size() - 1;
+
+	t_Pool        = this;
+	t_WorkerIndex = index;
+
+	while(_Unfinished.load(std::memory_order_acquire) > 0)
+	{
+		// Nothing left to pick up, the last few tasks are still running elsewhere.
+		if(!RunOne(index))
+			std::this_thread::yield();
+	}
+
+	t_Pool = nullptr;
+}
+
+size_t
+ThreadPool::CurrentWorker() const
+{
+	return t_Pool == this ? t_WorkerIndex : _Workers.size() - 1;
+}
+
+std::vector<ThreadPool::WorkerStats>
+ThreadPool::GetStats() const
+{
+	const auto elapsed = std::chrono::duration<double>(Clock::now() - _StatsStart).count();
+
+	std::vector<WorkerStats> stats(_Workers.size());
+	for(size_t i = 0; i < _Workers.size(); ++i)
+	{
+		const auto& worker   = *_Workers[i];
+		stats[i].TasksRun    = worker.TasksRun.load(std::memory_order_relaxed);
+		stats[i].TasksStolen = worker.TasksStolen.load(std::memory_order_relaxed);
+		stats[i].BusySeconds = static_cast<double>(worker.BusyNanoseconds.load(std::memory_order_relaxed)) * 1e-9;
+		stats[i].Utilization = elapsed > 0.0 ? stats[i].BusySeconds / elapsed : 0.0;
+	}
+	return stats;
+}
+
+uint64_t
+ThreadPool::GetBusyNanoseconds(const size_t worker) const
+{
+	return _Workers[worker]->BusyNanoseconds.load(std::memory_order_relaxed);
+}
+
+void
+ThreadPool::ResetStats()
+{
+	for(auto& worker : _Workers)
+	{
+		worker->TasksRun.store(0, std::memory_order_relaxed);
+		worker->TasksStolen.store(0, std::memory_order_relaxed);
+		worker->BusyNanoseconds.store(0, std::memory_order_relaxed);
+	}
+	_StatsStart = Clock::now();
+}
+
+void
+ThreadPool::WorkerLoop(const size_t index)
+{
+	t_Pool        = this;
+	t_WorkerIndex = index;
+
+	while(true)
+	{
+		if(RunOne(index))
+			continue;
+
+		std::unique_lock<std::mutex> lock(_SleepMutex);
+		_WakeUp.wait(lock, [this] { return _IsStopping || _Queued.load(std::memory_order_acquire) > 0; });
+		if(_IsStopping)
+			return;
+	}
+}
+
+bool
+ThreadPool::RunOne(const size_t index)
+{
+	if(_Queued.load(std::memory_order_acquire) == 0)
+		return false;
+
+	Task task;
+	auto isStolen = false;
+	if(!PopBack(index, task))
+	{
+		// Start with our neighbour so thieves don't all pile onto the same deque.
+		auto found = false;
+		for(size_t i = 1; i < _Workers.size() && !found; ++i)
+		{
+			found = StealFront((index + i) % _Workers.size(), task);
+		}
+		if(!found)
+			return false;
+		isStolen = true;
+	}
+	_Queued.fetch_sub(1, std::memory_order_relaxed);
+
+	const auto start = Clock::now();
+	task();
+	const auto busy = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+
+	auto& worker = *_Workers[index];
+	worker.TasksRun.fetch_add(1, std::memory_order_relaxed);
+	worker.BusyNanoseconds.fetch_add(static_cast<uint64_t>(busy), std::memory_order_relaxed);
+	if(isStolen)
+		worker.TasksStolen.fetch_add(1, std::memory_order_relaxed);
+
+	_Unfinished.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+bool
+ThreadPool::PopBack(const size_t index, Task& task)
+{
+	auto& worker = *_Workers[index];
+	std::lock_guard<std::mutex> lock(worker.Mutex);
+	if(worker.Head == worker.Tasks.size())
+		return false;
+
+	task = worker.Tasks.back();
+	worker.Tasks.pop_back();
+	if(worker.Head == worker.Tasks.size())
+	{
+		worker.Tasks.clear();
+		worker.Head = 0;
+	}
+	return true;
+}
+
+bool
+ThreadPool::StealFront(const size_t victim, Task& task)
+{
+	auto& worker = *_Workers[victim];
+	std::lock_guard<std::mutex> lock(worker.Mutex);
+	if(worker.Head == worker.Tasks.size())
+		return false;
+
+	task = worker.Tasks[worker.Head++];
+	if(worker.Head == worker.Tasks.size())
+	{
+		worker.Tasks.clear();
+		worker.Head = 0;
+	}
+	return true;
+}
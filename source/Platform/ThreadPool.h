@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "InlineFunction.h"
+
+// A fixed set of worker threads that live as long as the pool, each with its own task deque. A worker runs its
+// own tasks newest first and, when it runs dry, steals the oldest task from someone else, so a big task that splits
+// itself into pieces keeps every thread busy.
+//
+// Tasks are submitted from one owning thread, or from inside a running task to split work up. The owning thread
+// joins in while it Wait()s, so it counts as the last worker.
+class ThreadPool
+{
+public:
+	using Task = InlineFunction<48>;
+
+	struct WorkerStats
+	{
+		uint64_t TasksRun    = 0;
+		uint64_t TasksStolen = 0;
+		double BusySeconds   = 0.0;
+
+		// BusySeconds over the time since the stats were last reset.
+		double Utilization = 0.0;
+	};
+
+	// Zero sizes the pool to the hardware, with one worker per core including the owning thread.
+	explicit ThreadPool(size_t workerCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	size_t WorkerCount() const { return _Workers.size(); }
+
+	void Submit(const Task& task);
+
+	// Runs tasks on the calling thread until everything submitted so far, and everything they submitted, is done.
+	void Wait();
+
+	// The worker running the current task, from 0 to WorkerCount() - 1. Lets tasks write to per-worker scratch space
+	// without locking.
+	size_t CurrentWorker() const;
+
+	std::vector<WorkerStats> GetStats() const;
+	void ResetStats();
+
+	// How long a worker has spent running tasks since the stats were last reset. Cheap enough to sample around a
+	// single batch of work, and doesn't allocate like GetStats.
+	uint64_t GetBusyNanoseconds(size_t worker) const;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	struct Worker
+	{
+		// Owner pushes and pops at the back, thieves take from Head. Kept as a vector that rewinds when it empties,
+		// so a steady workload doesn't allocate.
+		std::mutex Mutex;
+		std::vector<Task> Tasks;
+		size_t Head = 0;
+
+		std::atomic<uint64_t> TasksRun { 0 };
+		std::atomic<uint64_t> TasksStolen { 0 };
+		std::atomic<uint64_t> BusyNanoseconds { 0 };
+	};
+
+	void WorkerLoop(size_t index);
+
+	// Runs one task from our own deque, or failing that one stolen from another. Returns false if there was none.
+	bool RunOne(size_t index);
+	bool PopBack(size_t index, Task& task);
+	bool StealFront(size_t victim, Task& task);
+
+	std::vector<std::unique_ptr<Worker>> _Workers;
+	std::vector<std::thread> _Threads;
+
+	// Tasks sitting in deques, and tasks not yet finished, running or not.
+	std::atomic<size_t> _Queued { 0 };
+	std::atomic<size_t> _Unfinished { 0 };
+
+	std::mutex _SleepMutex;
+	std::condition_variable _WakeUp;
+	bool _IsStopping = false;
+
+	// Spreads tasks submitted by the owning thread across the deques.
+	size_t _NextDeque = 0;
+
+	Clock::time_point _StatsStart;
+};
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Hierarchical timing wheel. Time is quantised into ticks of a fixed length, and each level is a ring of
+// SLOTS buckets, each level SLOTS times coarser than the one below. Scheduling and cancelling are O(1), and
+// advancing only touches the buckets that come due, plus an occasional cascade of a coarse bucket into the
+// finer levels as it comes into range.
+//
+// Entries fire on the first tick at or after their due time, so they run at most one tick late and never early.
+// Entries live in a pool threaded with intrusive lists, so a steady state schedules without allocating.
+template <typename T> class TimingWheel
+{
+public:
+	struct Handle
+	{
+		uint32_t Index      = INVALID;
+		uint32_t Generation = 0;
+
+		bool IsValid() const { return Index != INVALID; }
+	};
+
+	explicit TimingWheel(const float tickSeconds, const size_t capacity = 0)
+		: _TickSeconds(tickSeconds)
+	{
+		assert(tickSeconds > 0.0f);
+		_Heads.fill(INVALID);
+		_Nodes.reserve(capacity);
+	}
+
+	// Schedules `value` to expire at absolute time `time`, measured on the same clock passed to Advance().
+	Handle Schedule(const float time, const T& value)
+	{
+		// The current tick's bucket has already been processed, so anything due now goes out next tick.
+		auto expiry = static_cast<uint32_t>(std::ceil(time / _TickSeconds));
+		if(expiry <= _CurrentTick)
+			expiry = _CurrentTick + 1;
+
+		const auto index = AllocateNode();
+		auto& node       = _Nodes[index];
+		node.Value       = value;
+		node.Expiry      = expiry;
+
+		Insert(index);
+		++_Count;
+
+		return { index, node.Generation };
+	}
+
+	// Returns false if the handle has already fired, been cancelled, or was never valid.
+	bool Cancel(const Handle handle)
+	{
+		if(!IsPending(handle))
+			return false;
+
+		Unlink(handle.Index);
+		ReleaseNode(handle.Index);
+		--_Count;
+		return true;
+	}
+
+	bool IsPending(const Handle handle) const
+	{
+		return handle.Index < _Nodes.size() &&
+			_Nodes[handle.Index].Generation == handle.Generation &&
+			_Nodes[handle.Index].Bucket != FREE;
+	}
+
+	// Moves the wheel forward to `now`, calling onExpire(value) for everything that has come due. The callback
+	// may freely Schedule() or Cancel().
+	template <typename Fn> void Advance(const float now, Fn&& onExpire)
+	{
+		const auto target = static_cast<uint32_t>(std::floor(now / _TickSeconds));
+		while(_CurrentTick < target)
+		{
+			++_CurrentTick;
+
+			// When a level wraps, the next bucket up comes into range and gets spread over the levels below it.
+			// Cascade from the top down so entries can fall more than one level in a single tick.
+			auto level = 1;
+			while(level < LEVELS && (_CurrentTick & ((1u << (LEVEL_BITS * level)) - 1)) == 0)
+				++level;
+			for(auto l = level - 1; l >= 1; --l)
+				Cascade(l);
+
+			// Popping from the head each time keeps this safe against the callback cancelling its neighbours.
+			auto& head = _Heads[SlotFor(0, _CurrentTick)];
+			while(head != INVALID)
+			{
+				const auto index = head;
+				Unlink(index);
+				const auto value = _Nodes[index].Value;
+				ReleaseNode(index);
+				--_Count;
+
+				onExpire(value);
+			}
+		}
+	}
+
+	size_t Count() const
+	{
+		return _Count;
+	}
+
+	// How many entries fit before the pool has to grow.
+	size_t Capacity() const
+	{
+		return _Nodes.capacity();
+	}
+
+	// Drops everything that is pending. Outstanding handles are invalidated, not recycled.
+	void Clear()
+	{
+		// Every node goes back on the free list, not just the pending ones, or the ones already free would be lost.
+		// Walked backwards so the pool hands nodes out from the front again.
+		_Heads.fill(INVALID);
+		_FreeHead = INVALID;
+		for(auto i = static_cast<uint32_t>(_Nodes.size()); i-- > 0;)
+		{
+			if(_Nodes[i].Bucket != FREE)
+				++_Nodes[i].Generation;
+			_Nodes[i].Bucket = FREE;
+			_Nodes[i].Prev   = INVALID;
+			_Nodes[i].Next   = _FreeHead;
+			_FreeHead        = i;
+		}
+		_Count = 0;
+	}
+
+private:
+	static constexpr uint32_t INVALID    = UINT32_MAX;
+	static constexpr uint16_t FREE       = UINT16_MAX;
+	static constexpr uint32_t LEVEL_BITS = 6;
+	static constexpr uint32_t SLOTS      = 1u << LEVEL_BITS;
+	static constexpr int LEVELS          = 4;
+
+	// The furthest ahead we can file an entry. Anything later is parked in the top level and re-filed when
+	// that bucket cascades.
+	static constexpr uint32_t MAX_DELTA = (1u << (LEVEL_BITS * LEVELS)) - 1;
+
+	struct Node
+	{
+		T Value {};
+		uint32_t Expiry     = 0;
+		uint32_t Prev       = INVALID;
+		uint32_t Next       = INVALID;
+		uint32_t Generation = 0;
+		uint16_t Bucket     = FREE;
+	};
+
+	static uint32_t SlotFor(const int level, const uint32_t tick)
+	{
+		return level * SLOTS + ((tick >> (LEVEL_BITS * level)) & (SLOTS - 1));
+	}
+
+	void Insert(const uint32_t index)
+	{
+		auto& node       = _Nodes[index];
+		const auto delta = node.Expiry - _CurrentTick;
+
+		uint32_t bucket;
+		if(delta > MAX_DELTA)
+		{
+			bucket = SlotFor(LEVELS - 1, _CurrentTick + MAX_DELTA);
+		}
+		else
+		{
+			auto level = 0;
+			while(level < LEVELS - 1 && delta >= (1u << (LEVEL_BITS * (level + 1))))
+				++level;
+			bucket = SlotFor(level, node.Expiry);
+		}
+
+		node.Bucket = static_cast<uint16_t>(bucket);
+		node.Prev   = INVALID;
+		node.Next   = _Heads[bucket];
+		if(node.Next != INVALID)
+			_Nodes[node.Next].Prev = index;
+		_Heads[bucket] = index;
+	}
+
+	void Unlink(const uint32_t index)
+	{
+		auto& node = _Nodes[index];
+		if(node.Prev != INVALID)
+			_Nodes[node.Prev].Next = node.Next;
+		else
+			_Heads[node.Bucket] = node.Next;
+
+		if(node.Next != INVALID)
+			_Nodes[node.Next].Prev = node.Prev;
+	}
+
+	void Cascade(const int level)
+	{
+		auto& head = _Heads[SlotFor(level, _CurrentTick)];
+		while(head != INVALID)
+		{
+			const auto index = head;
+			Unlink(index);
+			Insert(index);
+		}
+	}
+
+	uint32_t AllocateNode()
+	{
+		if(_FreeHead != INVALID)
+		{
+			const auto index = _FreeHead;
+			_FreeHead        = _Nodes[index].Next;
+			return index;
+		}
+
+		_Nodes.emplace_back();
+		return static_cast<uint32_t>(_Nodes.size() - 1);
+	}
+
+	void ReleaseNode(const uint32_t index)
+	{
+		auto& node = _Nodes[index];
+		++node.Generation;
+		node.Bucket = FREE;
+		node.Prev   = INVALID;
+		node.Next   = _FreeHead;
+		_FreeHead   = index;
+	}
+
+	const float _TickSeconds;
+	uint32_t _CurrentTick = 0;
+
+	std::array<uint32_t, LEVELS * SLOTS> _Heads {};
+	std::vector<Node> _Nodes;
+	uint32_t _FreeHead = INVALID;
+
+	size_t _Count = 0;
+};
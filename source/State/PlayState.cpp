@@ -1,3 +1,5 @@
+#include <cmath>
+
 #include "PlayState.h"
 
 #include "../Math/EuanityMath.h"
@@ -12,6 +14,7 @@ PlayState::PlayState(Game& game)
 	  _Score(0),
 	  _WaitingForNextLevel(false),
 	  _WaitingToSpawn(false),
+	  _RespawnDue(false),
 	  _CurrentCamZoom(1),
 	  _CamZoomVelocity(0)
 {
@@ -28,6 +31,7 @@ PlayState::OnEnter()
 void
 PlayState::OnExit()
 {
+	_Game.Time.Cancel(_RespawnTimer);
 }
 
 
@@ -166,6 +170,7 @@ PlayState::RespawnAsteroids()
 #pragma endregion DifficultySettings
 
 	_CurrentAsteroids.reserve(numDesiredAsteroids);
+	_WaveSpawnPositions.clear();
 	for(auto i = _CurrentAsteroids.size(); i < numDesiredAsteroids; ++i)
 	{
 		auto playerPos = _Player.GetPlayerPosition();
@@ -177,8 +182,11 @@ PlayState::RespawnAsteroids()
 			spawnPosition.x = Math::Repeat(spawnPosition.x, _Game.GameFieldDim.x);
 			spawnPosition.y = Math::Repeat(spawnPosition.y, _Game.GameFieldDim.y);
 			++spawnAttempts;
-		} while(_Game.GameCam.GetCameraView().Contains(spawnPosition) &&
+		} while((_Game.GameCam.GetCameraView().Contains(spawnPosition) ||
+				_Game.Physics.IsOverlappingAnything(Circle(spawnPosition, ColliderUtils::Large)) ||
+				IsOverlappingWaveSpawn(spawnPosition)) &&
 			spawnAttempts < 10);
+		_WaveSpawnPositions.push_back(spawnPosition);
 
 		const auto piOverFour = Math::PI * 0.25f;
 		auto spawnVelocity    = (playerPos - spawnPosition).Normalized().RotateRad(Math::RandomRange(-piOverFour, piOverFour)) *
@@ -216,6 +224,13 @@ PlayState::UpdateCamera(const float& deltaTime)
 void
 PlayState::Update(const InputBuffer& inputBuffer, const float& deltaTime)
 {
+	if(_RespawnDue)
+	{
+		RespawnPlayer();
+		_RespawnDue     = false;
+		_WaitingToSpawn = false;
+	}
+
 	ProcessCollisions();
 
 	_Player.Update(inputBuffer, deltaTime);
@@ -236,10 +251,9 @@ PlayState::Update(const InputBuffer& inputBuffer, const float& deltaTime)
 			else
 			{
 				_WaitingToSpawn = true;
-				_Game.Time.ExecuteDelayed(1.5f, [&]()
+				_RespawnTimer   = _Game.Time.ExecuteDelayed(1.5f, [this]()
 				{
-					RespawnPlayer();
-					_WaitingToSpawn = false;
+					_RespawnDue = true;
 				});
 			}
 		}
@@ -255,8 +269,13 @@ PlayState::RespawnPlayer()
 
 	const auto spawnPoint = _Game.WrapToGameField(_Game.GameCam.GetFocalPoint() + (_Game.GameFieldDim * 0.5f));
 
+	static const auto RESPAWN_ATTEMPTS = 64;
+
+	// Now the check sees the asteroids, a crowded enough field might have nowhere safe, so give up eventually.
 	auto testCircle = Circle(spawnPoint, RESPAWN_CHECK_RADIUS);
-	while(_Game.Physics.IsOverlappingAnything(testCircle, _Player.GetShipColliderType()))
+	auto attempts   = 0;
+	while(_Game.Physics.IsOverlappingAnything(testCircle, _Player.GetShipColliderType()) &&
+		++attempts < RESPAWN_ATTEMPTS)
 	{
 		// Our selected spawnpoint is not safe to spawn in. Random walk to a new point!
 		testCircle.Center = _Game.WrapToGameField(testCircle.Center + (Math::RandomOnUnitCircle() * RESPAWN_CHECK_RADIUS));
@@ -265,6 +284,23 @@ PlayState::RespawnPlayer()
 	_Player.Spawn(testCircle.Center, 0);
 }
 
+bool
+PlayState::IsOverlappingWaveSpawn(const Vector2& position) const
+{
+	// Shortest way round the field, as a spawn near one edge can touch one near the other.
+	const auto& fieldDim = _Game.GameFieldDim;
+	const auto minDistSq = (ColliderUtils::Large + ColliderUtils::Large) * (ColliderUtils::Large + ColliderUtils::Large);
+	for(const auto& spawned : _WaveSpawnPositions)
+	{
+		auto delta = spawned - position;
+		delta.x -= std::round(delta.x / fieldDim.x) * fieldDim.x;
+		delta.y -= std::round(delta.y / fieldDim.y) * fieldDim.y;
+		if(delta.x * delta.x + delta.y * delta.y < minDistSq)
+			return true;
+	}
+	return false;
+}
+
 void
 PlayState::SpawnFirstAsteroid()
 {
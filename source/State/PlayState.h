@@ -3,6 +3,7 @@
 #include <vector>
 
 #include "../GameObject/Player.h"
+#include "Timer.h"
 
 #include "IState.h"
 
@@ -31,16 +32,28 @@ private:
 
 	std::vector<Entity> _CurrentAsteroids;
 
+	// Where the asteroids spawned so far in this wave went. The physics queries only see last Simulate's bodies, so
+	// each new spawn is checked against these as well.
+	std::vector<Vector2> _WaveSpawnPositions;
+
 	int _Lives;
 	uint32_t _Score;
 
 	bool _WaitingForNextLevel;
 	bool _WaitingToSpawn;
 
+	// Set by the respawn timer. Timers fire before physics has run, when there's nothing to check the spawn point
+	// against, so Update does the respawn.
+	bool _RespawnDue;
+
+	// The respawn callback captures this state, so it has to be cancelled if we leave before it fires.
+	Timer::Handle _RespawnTimer;
+
 	float _CurrentCamZoom;
 	float _CamZoomVelocity;
 
 	void RespawnPlayer();
 	void SpawnFirstAsteroid();
+	bool IsOverlappingWaveSpawn(const Vector2& position) const;
 
 };
@@ -1,25 +1,38 @@
-
 #include "Timer.h"
 
+Timer::Timer()
+	: _DeltaTime(0),
+	  _Time(0),
+	  _QueuedCalls(TICK_SECONDS, POOL_CAPACITY),
+	  _AllocationCount(0)
+{
+}
+
 void Timer::Update(const float deltaTime)
 {
 	this->_DeltaTime = deltaTime;
 	this->_Time += deltaTime;
 
-	while (_QueuedCalls.size() > 0)
-	{
-		const auto& [time, fn] = _QueuedCalls.top();
-		if (time < Now())
-		{
-			fn();
-			_QueuedCalls.pop();
-		}
-		else
-			return;
-	}
+	// Everything that came due this frame, in one pass.
+	_QueuedCalls.Advance(Now(), [](Callback fn) { fn(); });
+}
+
+Timer::Handle Timer::ExecuteDelayed(const float& seconds, const Callback& function)
+{
+	const auto capacity = _QueuedCalls.Capacity();
+	const auto handle   = _QueuedCalls.Schedule(Now() + seconds, function);
+	if(_QueuedCalls.Capacity() != capacity)
+		++_AllocationCount;
+
+	return handle;
+}
+
+bool Timer::Cancel(const Handle handle)
+{
+	return _QueuedCalls.Cancel(handle);
 }
 
-void Timer::ExecuteDelayed(const float& seconds, std::function<void()> function)
+bool Timer::IsPending(const Handle handle) const
 {
-	_QueuedCalls.push({ Now() + seconds, function });
+	return _QueuedCalls.IsPending(handle);
 }
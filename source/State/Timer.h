@@ -1,36 +1,45 @@
 #pragma once
 
-#include <queue>
-#include <functional>
-#include <vector>
+#include <cstdint>
+
+#include "../Platform/InlineFunction.h"
+#include "../Platform/TimingWheel.h"
 
 class Timer
 {
 public:
-	Timer() : _DeltaTime(0), _Time(0) {};
+	//@NOTE: Delayed calls are stored inline, so captures must fit in CALLBACK_BYTES and be trivially copyable.
+	// Capture `this` or references rather than containers.
+	static constexpr size_t CALLBACK_BYTES = 32;
+	using Callback = InlineFunction<CALLBACK_BYTES>;
+	using Handle   = TimingWheel<Callback>::Handle;
+
+	Timer();
 
 	void Update(float deltaTime);
 
 	const float& Now() const { return _Time; };
 	const float& DeltaTime() const { return _DeltaTime; }
-	void ExecuteDelayed(const float& seconds, std::function<void()> function);
 
-private:
-	float _DeltaTime;
-	float _Time;
+	// Calls `function` once `seconds` have passed. Keep the handle if the call might need cancelling, e.g. when
+	// it captures something that can be destroyed first.
+	Handle ExecuteDelayed(const float& seconds, const Callback& function);
+	bool Cancel(Handle handle);
+	bool IsPending(Handle handle) const;
 
-	class QueueCompare
-	{
-	public:
-		bool operator()(std::pair<float, std::function<void()>>& a, std::pair<float, std::function<void()>>& b) const
-		{
-			return a.first > b.first;
-		}
-	};
+	size_t PendingCount() const { return _QueuedCalls.Count(); }
 
-	std::priority_queue<std::pair<float, std::function<void()>>,
-		std::vector<std::pair<float, std::function<void()>>>,
-		QueueCompare> _QueuedCalls;
+	// Number of times the call pool has had to grow since construction. Stays flat once the game warms up.
+	uint32_t AllocationCount() const { return _AllocationCount; }
 
+private:
+	// Delayed calls fire on the first tick at or after their due time.
+	static constexpr float TICK_SECONDS  = 1.0f / 128.0f;
+	static constexpr size_t POOL_CAPACITY = 64;
+
+	float _DeltaTime;
+	float _Time;
 
+	TimingWheel<Callback> _QueuedCalls;
+	uint32_t _AllocationCount;
 };